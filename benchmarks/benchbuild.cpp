@@ -0,0 +1,100 @@
+#include <curvemanager/curvemanager.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace CurveManager;
+
+/*
+ * Cold build: parse, validate and build every curve of the fixture into a fresh store, forcing the
+ * bootstrap of each curve so that the lazy calculations are part of the measurement.
+ */
+static void BM_ColdBuild(benchmark::State& state, const std::string& fileName) {
+    json data = bench::readJSONFile(fileName);
+    for (auto _ : state) {
+        MarketStore store;
+        CurveBuilder builder(data, store);
+        builder.build();
+        bench::bootstrapAll(store);
+        benchmark::DoNotOptimize(store.allCurves());
+    }
+}
+BENCHMARK_CAPTURE(BM_ColdBuild, piecewise, std::string("piecewise.json"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdBuild, piecewisefull, std::string("piecewisefull.json"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdBuild, piecewisefull2, std::string("piecewisefull2.json"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ColdBuild, discount, std::string("discount.json"))->Unit(benchmark::kMillisecond);
+
+static void BM_ColdBuildParallel(benchmark::State& state, const std::string& fileName) {
+    json data = bench::readJSONFile(fileName);
+    for (auto _ : state) {
+        MarketStore store;
+        CurveBuilder builder(data, store);
+        builder.buildParallel();
+        benchmark::DoNotOptimize(store.allCurves());
+    }
+}
+BENCHMARK_CAPTURE(BM_ColdBuildParallel, piecewisefull, std::string("piecewisefull.json"))->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_ColdBuildParallel, piecewisefull2, std::string("piecewisefull2.json"))->Unit(benchmark::kMillisecond)->UseRealTime();
+
+namespace
+{
+    json quoteUpdate(MarketStore& store, const std::vector<std::string>& tickers, double shift) {
+        json prices = json::array();
+        for (const auto& ticker : tickers) {
+            json price;
+            price["NAME"]  = ticker;
+            price["VALUE"] = store.getQuote(ticker)->value() + shift;
+            prices.push_back(price);
+        }
+        return prices;
+    }
+
+#ifdef CURVEMANAGER_METRICS
+    // solver iterations of the last bootstrap of every curve of the store
+    uint64_t solverIterations(MarketStore& store) {
+        uint64_t total = 0;
+        for (const auto& name : store.allCurves()) total += store.metricsRegistry().curveMetrics(name).solverIterations;
+        return total;
+    }
+#endif
+
+    /*
+     * Alternates a one basis point bump and its reversal so the market does not drift between iterations. With
+     * metrics, the solverIterations counter is the sum over the curves of the iterations of their last bootstrap,
+     * to compare warm and cold starts.
+     */
+    void runUpdates(benchmark::State& state, bench::Fixture& fixture, const std::vector<std::string>& tickers) {
+        json up     = quoteUpdate(fixture.store, tickers, 0.0001);
+        json down   = quoteUpdate(fixture.store, tickers, 0.0);
+        bool bumped = false;
+        for (auto _ : state) {
+            auto affected = fixture.builder.updateQuotes(bumped ? down : up);
+            benchmark::DoNotOptimize(affected);
+            bumped = !bumped;
+        }
+#ifdef CURVEMANAGER_METRICS
+        state.counters["solverIterations"] = static_cast<double>(solverIterations(fixture.store));
+#endif
+        if (bumped) fixture.builder.updateQuotes(down);
+        state.SetItemsProcessed(state.iterations() * tickers.size());
+    }
+}  // namespace
+
+static void BM_SingleQuoteUpdate(benchmark::State& state, const std::string& fileName, bool warmStart) {
+    bench::Fixture& fixture = bench::fixture(fileName, warmStart);
+    runUpdates(state, fixture, {fixture.store.allQuotes().front()});
+}
+BENCHMARK_CAPTURE(BM_SingleQuoteUpdate, piecewise, std::string("piecewise.json"), false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SingleQuoteUpdate, piecewisefull, std::string("piecewisefull.json"), false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SingleQuoteUpdate, piecewisefull2, std::string("piecewisefull2.json"), false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SingleQuoteUpdate, piecewisefull_warm, std::string("piecewisefull.json"), true)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SingleQuoteUpdate, piecewisefull2_warm, std::string("piecewisefull2.json"), true)->Unit(benchmark::kMicrosecond);
+
+static void BM_FullQuoteUpdate(benchmark::State& state, const std::string& fileName, bool warmStart) {
+    bench::Fixture& fixture = bench::fixture(fileName, warmStart);
+    runUpdates(state, fixture, fixture.store.allQuotes());
+}
+BENCHMARK_CAPTURE(BM_FullQuoteUpdate, piecewise, std::string("piecewise.json"), false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FullQuoteUpdate, piecewisefull, std::string("piecewisefull.json"), false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FullQuoteUpdate, piecewisefull2, std::string("piecewisefull2.json"), false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FullQuoteUpdate, piecewisefull_warm, std::string("piecewisefull.json"), true)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FullQuoteUpdate, piecewisefull2_warm, std::string("piecewisefull2.json"), true)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,83 @@
+#include <curvemanager/curvemanager.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <set>
+
+using namespace CurveManager;
+
+/*
+ * Loading of a large config: the curves and indexes of the piecewisefull fixture replicated under new names
+ * (tickers are kept, so the copies share their quotes). Parsing is measured on its own; the load reports the
+ * validation and preprocessing times of the builder as counters, in milliseconds.
+ */
+namespace
+{
+    void renameCurves(json& node, const std::set<std::string>& names, const std::string& suffix) {
+        if (node.is_array()) {
+            for (auto& item : node) renameCurves(item, names, suffix);
+            return;
+        }
+        if (!node.is_object()) return;
+        for (auto it = node.begin(); it != node.end(); ++it) {
+            if (!it.value().is_string())
+                renameCurves(it.value(), names, suffix);
+            else if (!it.key().ends_with("TICKER") && names.count(it.value().get<std::string>()))
+                it.value() = it.value().get<std::string>() + suffix;
+        }
+    }
+
+    json replicatedConfig(size_t copies) {
+        json data = bench::readJSONFile("piecewisefull.json");
+        std::set<std::string> names;
+        for (const auto& curve : data.at("CURVES")) names.insert(curve.at("NAME").get<std::string>());
+        for (const auto& index : data.at("INDEXES")) names.insert(index.at("NAME").get<std::string>());
+
+        json config = {{"REFDATE", data.at("REFDATE")}, {"CURVES", json::array()}, {"INDEXES", json::array()}};
+        for (size_t k = 0; k < copies; ++k) {
+            json copy = data;
+            renameCurves(copy, names, "_" + std::to_string(k));
+            for (auto& curve : copy.at("CURVES")) config["CURVES"].push_back(std::move(curve));
+            for (auto& index : copy.at("INDEXES")) config["INDEXES"].push_back(std::move(index));
+        }
+        return config;
+    }
+
+    std::string configFile(size_t copies) {
+        std::string path = (std::filesystem::temp_directory_path() / ("curvemanager_bench_config_" + std::to_string(copies) + ".json")).string();
+        std::ofstream file(path);
+        file << replicatedConfig(copies).dump(4);
+        return path;
+    }
+}  // namespace
+
+static void BM_ConfigParse(benchmark::State& state) {
+    std::string path = configFile(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(readCurveConfig(path));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_ConfigParse)->Arg(10)->Arg(200)->Unit(benchmark::kMillisecond);
+
+// builder construction on a parsed config moved in (range(1) validation threads, 0 for one per core)
+static void BM_ConfigLoad(benchmark::State& state) {
+    json config       = replicatedConfig(static_cast<size_t>(state.range(0)));
+    double validateMs = 0.0, preprocessMs = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        json data = config;
+        {
+            MarketStore store;
+            state.ResumeTiming();
+            CurveBuilder builder(std::move(data), store, static_cast<size_t>(state.range(1)));
+            state.PauseTiming();
+            validateMs += builder.configLoadTimes().validateMs;
+            preprocessMs += builder.configLoadTimes().preprocessMs;
+        }
+        state.ResumeTiming();
+    }
+    state.counters["validateMs"]   = benchmark::Counter(validateMs, benchmark::Counter::kAvgIterations);
+    state.counters["preprocessMs"] = benchmark::Counter(preprocessMs, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ConfigLoad)->Args({10, 1})->Args({200, 1})->Args({200, 4})->Args({200, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
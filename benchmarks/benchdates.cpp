@@ -0,0 +1,76 @@
+#include <curvemanager/dateparser.hpp>
+#include <benchmark/benchmark.h>
+#include <qlp/parser.hpp>
+
+using namespace CurveManager;
+
+/*
+ * Per date cost of parsing request dates and formatting response dates, QuantLibParser against the fixed
+ * format parser and the caches. The payloads cycle over a few thousand distinct dates, like IMM dates and
+ * coupon schedules do in practice.
+ */
+namespace
+{
+    constexpr size_t distinctDates = 2000;
+
+    std::vector<Date> dates() {
+        std::vector<Date> result;
+        Date start(28, October, 2022);
+        for (size_t i = 0; i < distinctDates; ++i) result.push_back(start + static_cast<Date::serial_type>(7 * i));
+        return result;
+    }
+
+    std::vector<std::string> dateStrings() {
+        std::vector<std::string> result;
+        for (const auto& date : dates()) result.push_back(formatDDMMYYYY(date));
+        return result;
+    }
+}  // namespace
+
+static void BM_ParseDateQuantLibParser(benchmark::State& state) {
+    auto strings = dateStrings();
+    size_t i     = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(QuantLibParser::parse<Date>(strings[i++ % strings.size()]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseDateQuantLibParser);
+
+static void BM_ParseDateCached(benchmark::State& state) {
+    auto strings = dateStrings();
+    size_t i     = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(cachedParseDate(strings[i++ % strings.size()]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseDateCached);
+
+static void BM_ParseDateJSONCached(benchmark::State& state) {
+    json strings = dateStrings();
+    size_t i     = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(cachedParseDate(strings[i++ % strings.size()]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseDateJSONCached);
+
+static void BM_FormatDateQuantLibParser(benchmark::State& state) {
+    auto values = dates();
+    size_t i    = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(QuantLibParser::parseDate(values[i++ % values.size()], QuantLibParser::DateFormat::MIXED));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatDateQuantLibParser);
+
+static void BM_FormatDateCached(benchmark::State& state) {
+    auto values = dates();
+    size_t i    = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(cachedFormatDate(values[i++ % values.size()]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatDateCached);
+
+static void BM_FormatDDMMYYYY(benchmark::State& state) {
+    auto values = dates();
+    size_t i    = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(formatDDMMYYYY(values[i++ % values.size()]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatDDMMYYYY);
@@ -0,0 +1,129 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/encoding.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace CurveManager;
+
+namespace
+{
+    MarketStore& piecewiseStore() {
+        return bench::fixture("piecewise.json").store;
+    }
+
+    Date refDate() {
+        return piecewiseStore().getCurve("SOFR")->referenceDate();
+    }
+
+    json requestFor(const std::vector<Date::serial_type>& dates) {
+        json request;
+        request["REFDATE"] = formatDDMMYYYY(refDate());
+        request["CURVE"]   = "SOFR";
+        request["DATES"]   = json::array();
+        for (auto serial : dates) request["DATES"].push_back(formatDDMMYYYY(Date(serial)));
+        return request;
+    }
+
+    // the response of the json endpoint, as a tree
+    json responseFor(const std::vector<Date::serial_type>& dates, const std::vector<double>& values) {
+        json response = json::array();
+        for (size_t i = 0; i < dates.size(); ++i) {
+            json row;
+            row["DATE"]  = formatDDMMYYYY(Date(dates[i]));
+            row["VALUE"] = values[i];
+            response.push_back(row);
+        }
+        return response;
+    }
+
+    std::vector<uint8_t> encodedRequest(const std::vector<Date::serial_type>& dates, Encoding encoding) {
+        if (encoding != Encoding::Columnar) return encodeDocument(requestFor(dates), encoding);
+        ColumnarQuery query;
+        query.curve = "SOFR";
+        query.dates = dates;
+        return encodeColumnarQuery(query);
+    }
+
+    std::vector<double> discountsFor(const std::vector<Date::serial_type>& dates) {
+        std::vector<double> values(dates.size());
+        piecewiseStore().discounts("SOFR", dates.data(), dates.size(), values.data());
+        return values;
+    }
+
+    void encodingSizes(benchmark::internal::Benchmark* b) {
+        b->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+    }
+}  // namespace
+
+// response serialization: a json tree built and then dumped, against the direct encoder
+static void BM_EncodeResponseTree(benchmark::State& state, Encoding encoding) {
+    auto dates   = bench::queryDates(refDate(), state.range(0));
+    auto values  = discountsFor(dates);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        auto out = encodeDocument(responseFor(dates, values), encoding);
+        bytes    = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK_CAPTURE(BM_EncodeResponseTree, json, Encoding::JSON)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_EncodeResponseTree, cbor, Encoding::CBOR)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_EncodeResponseTree, msgpack, Encoding::MessagePack)->Apply(encodingSizes);
+
+static void BM_EncodeResponseDirect(benchmark::State& state, Encoding encoding) {
+    auto dates  = bench::queryDates(refDate(), state.range(0));
+    auto values = discountsFor(dates);
+    ResponseEncoder encoder(encoding);
+    for (auto _ : state) benchmark::DoNotOptimize(encoder.encode(dates.data(), values.data(), values.size()).data());
+    size_t bytes = encoder.buffer().size();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK_CAPTURE(BM_EncodeResponseDirect, json, Encoding::JSON)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_EncodeResponseDirect, cbor, Encoding::CBOR)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_EncodeResponseDirect, msgpack, Encoding::MessagePack)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_EncodeResponseDirect, columnar, Encoding::Columnar)->Apply(encodingSizes);
+
+// request parsing, up to the dates as serial numbers
+static void BM_DecodeRequest(benchmark::State& state, Encoding encoding) {
+    auto dates = bench::queryDates(refDate(), state.range(0));
+    auto in    = encodedRequest(dates, encoding);
+    std::vector<Date::serial_type> serials;
+    for (auto _ : state) {
+        if (encoding == Encoding::Columnar) {
+            serials = decodeColumnarQuery(in.data(), in.size()).dates;
+        }
+        else {
+            json request = decodeDocument(in.data(), in.size(), encoding);
+            serials.clear();
+            for (const auto& date : request.at("DATES")) serials.push_back(cachedParseDate(date).serialNumber());
+        }
+        benchmark::DoNotOptimize(serials.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(in.size()));
+    state.counters["bytes"] = static_cast<double>(in.size());
+}
+BENCHMARK_CAPTURE(BM_DecodeRequest, json, Encoding::JSON)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DecodeRequest, cbor, Encoding::CBOR)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DecodeRequest, msgpack, Encoding::MessagePack)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DecodeRequest, columnar, Encoding::Columnar)->Apply(encodingSizes);
+
+// whole discount request, from the encoded request to the encoded response, in the same encoding
+static void BM_DiscountRequestEncoded(benchmark::State& state, Encoding encoding) {
+    MarketStore& store = piecewiseStore();
+    auto in            = encodedRequest(bench::queryDates(refDate(), state.range(0)), encoding);
+    ResponseEncoder encoder(encoding);
+    for (auto _ : state) benchmark::DoNotOptimize(store.discountRequest(in.data(), in.size(), encoding, encoder).data());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(in.size() + encoder.buffer().size()));
+}
+BENCHMARK_CAPTURE(BM_DiscountRequestEncoded, json, Encoding::JSON)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DiscountRequestEncoded, cbor, Encoding::CBOR)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DiscountRequestEncoded, msgpack, Encoding::MessagePack)->Apply(encodingSizes);
+BENCHMARK_CAPTURE(BM_DiscountRequestEncoded, columnar, Encoding::Columnar)->Apply(encodingSizes);
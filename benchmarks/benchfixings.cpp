@@ -0,0 +1,133 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+
+using namespace CurveManager;
+
+/*
+ * Fixings load throughput (items are fixings): one addFixing per fixing against the bulk addFixings, and
+ * the columnar CSV and binary loaders end to end. The series are daily fixings of every index of the
+ * piecewisefull fixture over the given number of years; the histories are cleared between iterations.
+ */
+namespace
+{
+    FixingsTable fixingsTable(MarketStore& store, int years) {
+        FixingsTable fixings;
+        for (const auto& name : store.allIndexes()) {
+            auto index           = store.getIndex(name);
+            FixingSeries& series = fixings[name];
+            for (Date date(3, January, 2000); date < Date(3, January, 2000 + years); ++date) {
+                if (!index->isValidFixingDate(date)) continue;
+                series.dates.push_back(date);
+                series.values.push_back(0.01 + 1.0e-7 * date.serialNumber());
+            }
+        }
+        return fixings;
+    }
+
+    size_t fixingsCount(const FixingsTable& fixings) {
+        size_t n = 0;
+        for (const auto& [name, series] : fixings) n += series.dates.size();
+        return n;
+    }
+
+    void writeFixingsCSV(const std::string& path, const FixingsTable& fixings) {
+        std::vector<std::string> names;
+        std::map<Date, std::vector<std::string>> rows;
+        for (const auto& [name, series] : fixings) {
+            for (size_t i = 0; i < series.dates.size(); ++i) {
+                auto& row = rows[series.dates[i]];
+                row.resize(fixings.size());
+                row[names.size()] = std::to_string(series.values[i]);
+            }
+            names.push_back(name);
+        }
+        std::ofstream file(path);
+        file << "DATE";
+        for (const auto& name : names) file << "," << name;
+        file << "\n";
+        for (const auto& [date, row] : rows) {
+            file << formatDDMMYYYY(date);
+            for (const auto& cell : row) file << "," << cell;
+            file << "\n";
+        }
+    }
+
+    void clearFixings(MarketStore& store) {
+        for (const auto& name : store.allIndexes()) store.getIndex(name)->clearFixings();
+    }
+
+    std::string tempPath(const std::string& fileName) {
+        return (std::filesystem::temp_directory_path() / fileName).string();
+    }
+}  // namespace
+
+static void BM_AddFixingOneByOne(benchmark::State& state) {
+    bench::Fixture& fixture = bench::fixture("piecewisefull.json");
+    FixingsTable fixings    = fixingsTable(fixture.store, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        for (const auto& [name, series] : fixings)
+            for (size_t i = 0; i < series.dates.size(); ++i) fixture.store.addFixing(name, series.dates[i], series.values[i]);
+        state.PauseTiming();
+        clearFixings(fixture.store);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * fixingsCount(fixings));
+}
+BENCHMARK(BM_AddFixingOneByOne)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_AddFixingsBulk(benchmark::State& state) {
+    bench::Fixture& fixture = bench::fixture("piecewisefull.json");
+    FixingsTable fixings    = fixingsTable(fixture.store, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.store.addFixings(fixings));
+        state.PauseTiming();
+        clearFixings(fixture.store);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * fixingsCount(fixings));
+}
+BENCHMARK(BM_AddFixingsBulk)->Arg(1)->Arg(2)->Arg(20)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadFixings(benchmark::State& state, bool binary) {
+    bench::Fixture& fixture = bench::fixture("piecewisefull.json");
+    FixingsTable fixings    = fixingsTable(fixture.store, static_cast<int>(state.range(0)));
+    std::string path        = tempPath(binary ? "curvemanager_bench_fixings.bin" : "curvemanager_bench_fixings.csv");
+    if (binary)
+        writeFixingsBinary(path, fixings);
+    else
+        writeFixingsCSV(path, fixings);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.store.loadFixings(path));
+        state.PauseTiming();
+        clearFixings(fixture.store);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * fixingsCount(fixings));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+BENCHMARK_CAPTURE(BM_LoadFixings, csv, false)->Arg(20)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadFixings, binary, true)->Arg(20)->Unit(benchmark::kMillisecond);
+
+// parsing alone, without the insertion into the index histories
+static void BM_ReadFixings(benchmark::State& state, bool binary) {
+    bench::Fixture& fixture = bench::fixture("piecewisefull.json");
+    FixingsTable fixings    = fixingsTable(fixture.store, static_cast<int>(state.range(0)));
+    std::string path        = tempPath(binary ? "curvemanager_bench_read.bin" : "curvemanager_bench_read.csv");
+    if (binary)
+        writeFixingsBinary(path, fixings);
+    else
+        writeFixingsCSV(path, fixings);
+
+    for (auto _ : state) benchmark::DoNotOptimize(readFixings(path));
+    state.SetItemsProcessed(state.iterations() * fixingsCount(fixings));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+}
+BENCHMARK_CAPTURE(BM_ReadFixings, csv, false)->Arg(20)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ReadFixings, binary, true)->Arg(20)->Unit(benchmark::kMillisecond);
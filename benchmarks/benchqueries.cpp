@@ -0,0 +1,116 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+#include <ql/time/daycounters/actual360.hpp>
+
+using namespace CurveManager;
+
+namespace
+{
+    MarketStore& piecewiseStore() {
+        return bench::fixture("piecewise.json").store;
+    }
+
+    Date refDate() {
+        return piecewiseStore().getCurve("SOFR")->referenceDate();
+    }
+
+    json requestFor(const std::vector<Date::serial_type>& dates) {
+        json request;
+        request["REFDATE"] = formatDDMMYYYY(refDate());
+        request["CURVE"]   = "SOFR";
+        request["DATES"]   = json::array();
+        for (auto serial : dates) request["DATES"].push_back(formatDDMMYYYY(Date(serial)));
+        return request;
+    }
+
+    json forwardRequestFor(const std::vector<Date::serial_type>& dates) {
+        json request = requestFor({});
+        json& pairs  = request["DATES"];
+        for (auto serial : dates) pairs.push_back({formatDDMMYYYY(Date(serial)), formatDDMMYYYY(Date(serial) + Period(3, Months))});
+        return request;
+    }
+
+    void querySizes(benchmark::internal::Benchmark* b) {
+        b->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+    }
+}  // namespace
+
+static void BM_DiscountRequestJSON(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    json request       = requestFor(bench::queryDates(refDate(), state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(store.discountRequest(request));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DiscountRequestJSON)->Apply(querySizes);
+
+static void BM_DiscountsBatch(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    auto dates         = bench::queryDates(refDate(), state.range(0));
+    std::vector<double> out(dates.size());
+    for (auto _ : state) {
+        store.discounts("SOFR", dates.data(), dates.size(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DiscountsBatch)->Apply(querySizes);
+
+static void BM_DiscountsBatchById(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    CurveId curve      = store.curveId("SOFR");
+    auto dates         = bench::queryDates(refDate(), state.range(0));
+    std::vector<double> out(dates.size());
+    for (auto _ : state) {
+        store.discounts(curve, dates.data(), dates.size(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DiscountsBatchById)->Apply(querySizes);
+
+static void BM_ZeroRateRequestJSON(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    json request       = requestFor(bench::queryDates(refDate(), state.range(0)));
+    request["DAYCOUNTER"]  = "ACT360";
+    request["COMPOUNDING"] = "COMPOUNDED";
+    request["FREQUENCY"]   = "ANNUAL";
+    for (auto _ : state) benchmark::DoNotOptimize(store.zeroRateRequest(request));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ZeroRateRequestJSON)->Apply(querySizes);
+
+static void BM_ZeroRatesBatch(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    auto dates         = bench::queryDates(refDate(), state.range(0));
+    std::vector<double> out(dates.size());
+    for (auto _ : state) {
+        store.zeroRates("SOFR", dates.data(), dates.size(), Actual360(), Compounded, Annual, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ZeroRatesBatch)->Apply(querySizes);
+
+static void BM_ForwardRateRequestJSON(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    json request       = forwardRequestFor(bench::queryDates(refDate(), state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(store.forwardRateRequest(request));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ForwardRateRequestJSON)->Apply(querySizes);
+
+static void BM_ForwardRatesBatch(benchmark::State& state) {
+    MarketStore& store = piecewiseStore();
+    auto startDates    = bench::queryDates(refDate(), state.range(0));
+    std::vector<Date::serial_type> endDates(startDates.size());
+    for (size_t i = 0; i < startDates.size(); ++i) endDates[i] = (Date(startDates[i]) + Period(3, Months)).serialNumber();
+    std::vector<double> out(startDates.size());
+    for (auto _ : state) {
+        store.forwardRates("SOFR", startDates.data(), endDates.data(), startDates.size(), Actual360(), Simple, Annual, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ForwardRatesBatch)->Apply(querySizes);
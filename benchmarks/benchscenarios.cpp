@@ -0,0 +1,52 @@
+#include <curvemanager/scenarioengine.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace CurveManager;
+
+namespace
+{
+    const std::vector<Time> pillars = {0.25, 0.5, 1.0, 2.0, 3.0, 5.0, 7.0, 10.0, 15.0, 20.0, 30.0};
+
+    // parallel shifts, key rate bumps at every pillar and twists, cycled up to nScenarios rows
+    Matrix scenarioSpreads(const ScenarioEngine& engine, size_t nScenarios) {
+        std::vector<std::vector<double>> shapes;
+        for (double shift : {-0.02, -0.01, 0.01, 0.02}) shapes.push_back(engine.parallel(shift));
+        for (size_t i = 0; i < pillars.size(); ++i) shapes.push_back(engine.keyRate(i, 0.0001));
+        for (double shift : {-0.01, 0.01}) shapes.push_back(engine.twist(shift, -shift));
+
+        Matrix spreads(nScenarios, pillars.size());
+        for (size_t s = 0; s < nScenarios; ++s) std::copy(shapes[s % shapes.size()].begin(), shapes[s % shapes.size()].end(), spreads.row_begin(s));
+        return spreads;
+    }
+}  // namespace
+
+// scenarios x dates discounts; the rebootstrap alternative is BM_FullQuoteUpdate once per scenario
+static void BM_ScenarioDiscounts(benchmark::State& state, SpreadType type) {
+    MarketStore& store = bench::fixture("piecewise.json").store;
+    ScenarioEngine engine(store, "SOFR", pillars, type);
+    Matrix spreads = scenarioSpreads(engine, state.range(0));
+    auto dates     = bench::queryDates(engine.curve().referenceDate(), state.range(1));
+    std::vector<double> out(spreads.rows() * dates.size());
+    for (auto _ : state) {
+        engine.discounts(spreads.begin(), spreads.rows(), dates.data(), dates.size(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK_CAPTURE(BM_ScenarioDiscounts, zero, SpreadType::Zero)->ArgsProduct({{10, 100, 1000}, {100, 10000}})->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ScenarioDiscounts, forward, SpreadType::Forward)->ArgsProduct({{10, 100, 1000}, {100, 10000}})->Unit(benchmark::kMicrosecond);
+
+static void BM_ScenarioZeroRates(benchmark::State& state) {
+    MarketStore& store = bench::fixture("piecewise.json").store;
+    ScenarioEngine engine(store, "SOFR", pillars, SpreadType::Zero);
+    Matrix spreads = scenarioSpreads(engine, state.range(0));
+    auto dates     = bench::queryDates(engine.curve().referenceDate(), state.range(1));
+    std::vector<double> out(spreads.rows() * dates.size());
+    for (auto _ : state) {
+        engine.zeroRates(spreads.begin(), spreads.rows(), dates.data(), dates.size(), engine.curve().dayCounter(), Continuous, Annual, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_ScenarioZeroRates)->ArgsProduct({{10, 100, 1000}, {100, 10000}})->Unit(benchmark::kMicrosecond);
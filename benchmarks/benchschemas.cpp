@@ -0,0 +1,50 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/schemaregistry.hpp>
+#include <curvemanager/schemas/all.hpp>
+#include "benchutils.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace CurveManager;
+using namespace QuantLibParser;
+
+namespace
+{
+    MarketStore& discountStore() {
+        static MarketStore store;
+        static CurveBuilder builder(bench::readJSONFile("discount.json"), store);
+        [[maybe_unused]] static bool built = (builder.build(), true);
+        return store;
+    }
+
+    const json request = R"({"REFDATE":"28082022", "DATES":["29012026"], "CURVE":"SOFR"})"_json;
+}  // namespace
+
+// cost paid by every request before the registry: compiling the schema and its validator
+static void BM_SchemaConstruction(benchmark::State& state) {
+    for (auto _ : state) {
+        Schema<DiscountFactorsRequest> schema;
+        benchmark::DoNotOptimize(&schema);
+    }
+}
+BENCHMARK(BM_SchemaConstruction);
+
+static void BM_SchemaValidateCached(benchmark::State& state) {
+    auto& schema = cachedSchema<DiscountFactorsRequest>();
+    for (auto _ : state) schema.validate(request);
+}
+BENCHMARK(BM_SchemaValidateCached);
+
+static void BM_DiscountRequestValidated(benchmark::State& state) {
+    MarketStore& store = discountStore();
+    store.setTrustedInput(false);
+    for (auto _ : state) benchmark::DoNotOptimize(store.discountRequest(request));
+}
+BENCHMARK(BM_DiscountRequestValidated);
+
+static void BM_DiscountRequestTrusted(benchmark::State& state) {
+    MarketStore& store = discountStore();
+    store.setTrustedInput(true);
+    for (auto _ : state) benchmark::DoNotOptimize(store.discountRequest(request));
+    store.setTrustedInput(false);
+}
+BENCHMARK(BM_DiscountRequestTrusted);
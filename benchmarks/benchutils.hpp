@@ -0,0 +1,58 @@
+#ifndef ECF81D1E_23E4_47FD_9E64_733D5D041216
+#define ECF81D1E_23E4_47FD_9E64_733D5D041216
+
+#include <curvemanager/curvemanager.hpp>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace bench
+{
+    using json = nlohmann::json;
+
+    inline json readJSONFile(const std::string& fileName) {
+        std::ifstream file(std::string(CURVEMANAGER_JSON_DIR) + "/" + fileName);
+        std::ostringstream tmp;
+        tmp << file.rdbuf();
+        json data = json::parse(tmp.str());
+        // piecewisefull2.json has no reference date of its own
+        if (!data.contains("REFDATE")) data["REFDATE"] = "28102022";
+        return data;
+    }
+
+    inline void bootstrapAll(CurveManager::MarketStore& store) {
+        for (const auto& name : store.allCurves()) store.getCurve(name)->discount(0.0, true);
+    }
+
+    /*
+     * Built and bootstrapped store for a fixture, shared by all the benchmarks of the process. The curves
+     * are bootstrapped eagerly since their reference dates do not follow later changes of the evaluation date.
+     */
+    struct Fixture {
+        explicit Fixture(const std::string& fileName, bool warmStart = false) : data(readJSONFile(fileName)), store(), builder(data, store) {
+            builder.setWarmStart(warmStart);
+            builder.build();
+            bootstrapAll(store);
+        }
+        json data;
+        CurveManager::MarketStore store;
+        CurveManager::CurveBuilder builder;
+    };
+
+    inline Fixture& fixture(const std::string& fileName, bool warmStart = false) {
+        static std::map<std::string, std::unique_ptr<Fixture>> fixtures;
+        auto& ptr = fixtures[warmStart ? fileName + ":warm" : fileName];
+        if (!ptr) ptr = std::make_unique<Fixture>(fileName, warmStart);
+        return *ptr;
+    }
+
+    // evenly spaced query dates, as serial numbers, starting after the reference date
+    inline std::vector<QuantLib::Date::serial_type> queryDates(const QuantLib::Date& refDate, size_t n) {
+        std::vector<QuantLib::Date::serial_type> dates(n);
+        for (size_t i = 0; i < n; ++i) dates[i] = refDate.serialNumber() + 1 + static_cast<QuantLib::Date::serial_type>(i % 10950);
+        return dates;
+    }
+}  // namespace bench
+
+#endif /* ECF81D1E_23E4_47FD_9E64_733D5D041216 */
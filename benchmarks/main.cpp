@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * Same as benchmark_main, but unless told otherwise the results are also written as JSON to
+ * curvemanager_bench.json, so that runs of different releases can be compared (e.g. with
+ * the tools/compare.py script shipped with Google Benchmark).
+ */
+int main(int argc, char** argv) {
+    bool hasOut = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) hasOut = true;
+    }
+
+    std::string out    = "--benchmark_out=curvemanager_bench.json";
+    std::string format = "--benchmark_out_format=json";
+    std::vector<char*> args(argv, argv + argc);
+    if (!hasOut) {
+        args.push_back(&out[0]);
+        args.push_back(&format[0]);
+    }
+    int nArgs = static_cast<int>(args.size());
+
+    benchmark::Initialize(&nArgs, args.data());
+    if (benchmark::ReportUnrecognizedArguments(nArgs, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,192 @@
+#ifndef DA06794D_699E_4479_9D77_03BCB97E0BB7
+#define DA06794D_699E_4479_9D77_03BCB97E0BB7
+
+#include <curvemanager/warmstartbootstrap.hpp>
+#include <ql/math/interpolations/cubicinterpolation.hpp>
+#include <ql/math/interpolations/linearinterpolation.hpp>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    // natural cubic spline with Hyman's monotonicity filter
+    class MonotonicCubic : public Cubic {
+       public:
+        MonotonicCubic()
+        : Cubic(CubicInterpolation::Spline, true, CubicInterpolation::SecondDerivative, 0.0, CubicInterpolation::SecondDerivative, 0.0){};
+    };
+
+    template <typename... Ts>
+    struct TypeList {};
+
+    template <typename T>
+    struct TypeTag {
+        using type = T;
+    };
+
+    // name of a traits or interpolator type in the curve configs (TRAITS and INTERPOLATION of a PIECEWISE curve)
+    template <typename T>
+    struct ConfigName;
+    template <>
+    struct ConfigName<Discount> {
+        static constexpr const char* value = "DISCOUNT";
+    };
+    template <>
+    struct ConfigName<ZeroYield> {
+        static constexpr const char* value = "ZEROYIELD";
+    };
+    template <>
+    struct ConfigName<ForwardRate> {
+        static constexpr const char* value = "FORWARDRATE";
+    };
+    template <>
+    struct ConfigName<Linear> {
+        static constexpr const char* value = "LINEAR";
+    };
+    template <>
+    struct ConfigName<LogLinear> {
+        static constexpr const char* value = "LOGLINEAR";
+    };
+    template <>
+    struct ConfigName<Cubic> {
+        static constexpr const char* value = "CUBIC";
+    };
+    template <>
+    struct ConfigName<MonotonicCubic> {
+        static constexpr const char* value = "MONOTONICCUBIC";
+    };
+
+    // the combinations a piecewise curve can be built with; each one is instantiated once, here
+    using PiecewiseTraits        = TypeList<Discount, ZeroYield, ForwardRate>;
+    using PiecewiseInterpolators = TypeList<Linear, LogLinear, Cubic, MonotonicCubic>;
+
+    template <typename... Ts>
+    std::vector<std::string> configNames(TypeList<Ts...>) {
+        return {ConfigName<Ts>::value...};
+    }
+
+    // calls f(TypeTag<T>()) for the type of the list named name; false if there is none
+    template <typename... Ts, typename F>
+    bool dispatchByName(TypeList<Ts...>, const std::string& name, F&& f) {
+        return ((name == ConfigName<Ts>::value ? (f(TypeTag<Ts>()), true) : false) || ...);
+    }
+
+    template <class Traits = Discount, class Interpolator = LogLinear>
+    using PiecewiseCurve = PiecewiseYieldCurve<Traits, Interpolator, WarmStartBootstrap>;
+
+    /*
+     * Type erased handle on a PiecewiseCurve of any traits and interpolator. The operations go through a
+     * static table of plain function pointers, one per instantiation, so the store freezes, recalculates and
+     * reads the nodes of its curves without virtual calls or RTTI casts. Default constructed, it holds no
+     * curve (the curve was not bootstrapped, e.g. a DISCOUNT or FLATFORWARD curve).
+     */
+    class BootstrappedCurve {
+       public:
+        BootstrappedCurve() = default;
+
+        template <class Traits, class Interpolator>
+        explicit BootstrappedCurve(const boost::shared_ptr<PiecewiseCurve<Traits, Interpolator>>& curve)
+        : curve_(curve), object_(curve.get()), ops_(opsOf<PiecewiseCurve<Traits, Interpolator>>()){};
+
+        explicit operator bool() const {
+            return ops_ != nullptr;
+        };
+        const boost::shared_ptr<YieldTermStructure>& termStructure() const {
+            return curve_;
+        };
+
+        void freeze() const {
+            ops_->freeze(object_);
+        };
+        void unfreeze() const {
+            ops_->unfreeze(object_);
+        };
+        void recalculate() const {
+            ops_->recalculate(object_);
+        };
+
+        // node dates, times and values in the units of the traits (discounts, zero or forward rates); they run the bootstrap if needed
+        const std::vector<Date>& dates() const {
+            return ops_->dates(object_);
+        };
+        const std::vector<Time>& times() const {
+            return ops_->times(object_);
+        };
+        const std::vector<Real>& data() const {
+            return ops_->data(object_);
+        };
+        // discount factors at the node dates
+        std::vector<Real> nodeDiscounts() const {
+            if (ops_->discountTraits) return data();
+            std::vector<Real> discounts;
+            for (Time t : times()) discounts.push_back(curve_->discount(t, true));
+            return discounts;
+        };
+
+        /*
+         * Read-only interpolated curve over a copy of the current nodes, with the traits and interpolator of
+         * the piecewise curve: the same values, but no helpers to observe, so quote updates leave it unchanged.
+         */
+        boost::shared_ptr<const YieldTermStructure> nodeCopy() const {
+            return ops_->nodeCopy(object_);
+        };
+
+        // true when the nodes are log-linearly interpolated discounts, so that they reproduce the whole curve
+        bool isLogLinearDiscount() const {
+            return ops_ && ops_->logLinearDiscount;
+        };
+        const char* traits() const {
+            return ops_->traits;
+        };
+        const char* interpolation() const {
+            return ops_->interpolation;
+        };
+
+       private:
+        struct Ops {
+            void (*freeze)(void*);
+            void (*unfreeze)(void*);
+            void (*recalculate)(void*);
+            const std::vector<Date>& (*dates)(const void*);
+            const std::vector<Time>& (*times)(const void*);
+            const std::vector<Real>& (*data)(const void*);
+            boost::shared_ptr<const YieldTermStructure> (*nodeCopy)(const void*);
+            bool discountTraits;
+            bool logLinearDiscount;
+            const char* traits;
+            const char* interpolation;
+        };
+
+        template <class Curve>
+        static const Ops* opsOf() {
+            using Traits       = typename Curve::traits_type;
+            using Interpolator = typename Curve::interpolator_type;
+            static const Ops ops{[](void* curve) { static_cast<Curve*>(curve)->freeze(); },
+                                 [](void* curve) { static_cast<Curve*>(curve)->unfreeze(); },
+                                 [](void* curve) { static_cast<Curve*>(curve)->recalculate(); },
+                                 [](const void* curve) -> const std::vector<Date>& { return static_cast<const Curve*>(curve)->dates(); },
+                                 [](const void* curve) -> const std::vector<Time>& { return static_cast<const Curve*>(curve)->times(); },
+                                 [](const void* curve) -> const std::vector<Real>& { return static_cast<const Curve*>(curve)->data(); },
+                                 [](const void* curve) -> boost::shared_ptr<const YieldTermStructure> {
+                                     using Copy     = typename Traits::template curve<Interpolator>::type;
+                                     const Curve* c = static_cast<const Curve*>(curve);
+                                     return boost::shared_ptr<const YieldTermStructure>(
+                                         new Copy(c->dates(), c->data(), c->dayCounter(), c->calendar()));
+                                 },
+                                 std::is_same_v<Traits, Discount>,
+                                 std::is_same_v<Traits, Discount> && std::is_same_v<Interpolator, LogLinear>,
+                                 ConfigName<Traits>::value,
+                                 ConfigName<Interpolator>::value};
+            return &ops;
+        };
+
+        boost::shared_ptr<YieldTermStructure> curve_;
+        void* object_   = nullptr;
+        const Ops* ops_ = nullptr;
+    };
+}  // namespace CurveManager
+
+#endif /* DA06794D_699E_4479_9D77_03BCB97E0BB7 */
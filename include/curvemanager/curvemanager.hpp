@@ -7,10 +7,15 @@
 #ifndef A02E616D_E693_447C_B341_9A3B4E69200A
 #define A02E616D_E693_447C_B341_9A3B4E69200A
 
+#include <curvemanager/evaluationdate.hpp>
 #include <curvemanager/marketstore.hpp>
 #include <ql/termstructures/yield/ratehelpers.hpp>
+#include <functional>
+#include <iosfwd>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <set>
 #include <stdexcept>
 
 namespace CurveManager
@@ -18,25 +23,134 @@ namespace CurveManager
     using namespace QuantLib;
     using json = nlohmann::json;
 
+    /*
+     * Node dates and discount factors of a curve of the store, which reproduce it with log-linear interpolation
+     * unless it is a piecewise curve of other traits or interpolator; false if the curve type is not supported (also
+     * for flat forwards with simple rates, which are not log-linear in t).
+     */
+    bool curveNodes(const MarketStore& store, const std::string& name, std::vector<Date::serial_type>& dates, std::vector<double>& values);
+
+    /*
+     * Curve configs parsed straight from a file (memory mapped) or a stream, without an intermediate string.
+     * Hand the result to CurveBuilder as an rvalue so that it is moved in rather than copied.
+     */
+    json readCurveConfig(const std::string& path);
+    json readCurveConfig(std::istream& stream);
+
+    // wall times in milliseconds of the loading of a config by CurveBuilder
+    struct ConfigLoadTimes {
+        double validateMs   = 0.0;  // request schema, and validation and defaults of the curve and index blocks
+        double preprocessMs = 0.0;  // curve handles, indexes and dependency graph
+    };
+
+    /*
+     * Builders run every QuantLib call under an EvaluationDateLock for their REFDATE, so independent
+     * MarketStore/CurveBuilder pairs can be used from separate threads, also for different dates. build
+     * bootstraps the curves eagerly, so that queries on the store never trigger a bootstrap outside the lock.
+     */
     class CurveBuilder {
        public:
-        CurveBuilder(const json& data, MarketStore& marketStore);
+        /*
+         * The config is taken by value and its curve and index blocks are moved into the builder, so an rvalue
+         * (std::move, readCurveConfig) is never deep copied. The blocks are validated and filled with their
+         * defaults on nThreads workers (0 means one per core); with a store in trusted input mode only the
+         * defaults are filled in.
+         */
+        CurveBuilder(json data, MarketStore& marketStore, size_t nThreads = 1);
+        ~CurveBuilder();
         void build();
-        void updateQuotes(const json& prices);
+        /*
+         * Bootstraps the curves in topological waves of the dependency graph, running the curves
+         * of each wave on nThreads workers (0 means one per core).
+         */
+        void buildParallel(size_t nThreads = 0);
+        /*
+         * Sets the quotes and rebootstraps only the curves that depend on them, directly or through
+         * other curves. Returns the recalculated curves in the order they were bootstrapped.
+         */
+        std::vector<std::string> updateQuotes(const json& prices);
+        // same, with the quotes given by id (see MarketStore::quoteId) and without schema validation
+        std::vector<std::string> updateQuotes(const std::vector<QuoteId>& quotes, const std::vector<double>& values);
+        std::vector<std::string> affectedCurves(const std::set<std::string>& tickers) const;
+        std::vector<std::string> affectedCurves(const std::vector<QuoteId>& quotes) const;
+
+        /*
+         * Jacobian of the node discount factors of a piecewise curve with respect to the quotes of its rate
+         * helpers, computed after the bootstrap from the implicit function theorem: copies of the helpers,
+         * built once per curve over their own handle, are repriced on discount curves over the nodes with one
+         * node bumped at a time (finite differences, no solver runs), and the resulting quote/node matrix is
+         * inverted. The store handle and the bootstrap helpers are not touched, and quotes of other curves are
+         * held fixed. With the Jacobian mode on, every build and quote update computes them.
+         */
+        void computeJacobian(const std::string& name);
+        void setJacobianMode(bool enabled);
+
+        /*
+         * Warm start of the piecewise bootstraps (see WarmStartBootstrap) of the curves built from now on: quote
+         * updates search each node around the last solution, within bracketWidth on the segment's forward rate,
+         * and rebootstrap seeds the new curves with the nodes of the ones they replace.
+         */
+        void setWarmStart(bool enabled, double bracketWidth = 1.0e-3);
+
+        /*
+         * Binary warm start: save writes the bootstrapped nodes of every curve (the parameters of flat forwards),
+         * the quotes and the index fixings; restore relinks the curve handles to node curves (no solver involved) and loads the
+         * quotes and fixings. rebootstrap rebuilds the curves from their configs and the current quotes.
+         */
+        void save(const std::string& path) const;
+        void restore(const std::string& path);
+        void rebootstrap();
+
+        std::vector<std::vector<std::string>> buildWaves() const;
+        const std::set<std::string>& curveDependencies(const std::string& name) const;
+        // wall time in milliseconds spent building and bootstrapping each curve in the last buildParallel
+        const std::unordered_map<std::string, double>& buildTimes() const;
+        const ConfigLoadTimes& configLoadTimes() const;
+        const Date& referenceDate() const;
 
        private:
-        void preprocessData();
+        void preprocessData(json& data, size_t nThreads);
+        void buildDependencies();
+        void bootstrapCurve(const std::string& name);
+        /*
+         * Runs the bootstrap of a curve and returns its wall time in milliseconds. With CURVEMANAGER_METRICS it
+         * is also recorded in the store metrics, with the solver iterations read off the helper quotes.
+         */
+        double timedBootstrap(const std::string& name,
+                              const std::vector<boost::shared_ptr<RateHelper>>& helpers,
+                              const std::function<void()>& bootstrap);
         void buildCurve(const std::string& name, const json& curve);
+        bool supportsJacobian(const std::string& name) const;
+        // copies of the helpers of a curve that discount and forecast on their own handle
+        struct JacobianHelpers {
+            RelinkableHandle<YieldTermStructure> handle;
+            std::vector<boost::shared_ptr<RateHelper>> helpers;
+        };
+        JacobianHelpers& jacobianHelpers(const std::string& name);
         boost::shared_ptr<YieldTermStructure> buildDiscountCurve(const std::string& name, const json& curve);
         boost::shared_ptr<YieldTermStructure> buildFlatForwardCurve(const std::string& name, const json& curve);
-        boost::shared_ptr<YieldTermStructure> buildPiecewiseCurve(const std::string& name, const json& curve);
-        std::vector<boost::shared_ptr<RateHelper>> buildRateHelpers(const json& rateHelperVector, const std::string& currentCurve);
+        BootstrappedCurve buildPiecewiseCurve(const std::string& name, const json& curve);
+        // with ownHandle, the helpers use it wherever they would use the store handle of currentCurve
+        std::vector<boost::shared_ptr<RateHelper>> buildRateHelpers(const json& rateHelperVector,
+                                                                    const std::string& currentCurve,
+                                                                    RelinkableHandle<YieldTermStructure>* ownHandle = nullptr);
         boost::shared_ptr<IborIndex> buildIndex(const std::string& name);
 
-        json data_;
+        Date refDate_;
         MarketStore& marketStore_;
         std::unordered_map<std::string, json> curveConfigs_;
         std::unordered_map<std::string, json> indexConfigs_;
+        std::unordered_map<std::string, std::set<std::string>> curveDependencies_;
+        std::unordered_map<std::string, std::set<std::string>> curveDependents_;
+        std::vector<std::set<std::string>> quoteCurves_;  // indexed by QuoteId
+        std::unordered_map<std::string, double> buildTimes_;
+        ConfigLoadTimes configLoadTimes_;
+        std::unordered_map<std::string, std::vector<boost::shared_ptr<RateHelper>>> curveHelpers_;
+        std::unordered_map<std::string, JacobianHelpers> jacobianHelpers_;
+        bool jacobianMode_     = false;
+        bool warmStart_        = false;
+        double warmStartWidth_ = 1.0e-3;
+        std::mutex buildMutex_;
     };
 
 }  // namespace CurveManager
@@ -0,0 +1,161 @@
+#ifndef C8DA981B_4D89_45DF_BA87_6148E0777E2A
+#define C8DA981B_4D89_45DF_BA87_6148E0777E2A
+
+#include <curvemanager/bootstrappedcurve.hpp>
+#include <curvemanager/symboltable.hpp>
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+#include <ql/time/daycounter.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    class MarketStore;
+
+    /*
+     * Immutable copy of a bootstrapped curve: node times and log discount factors in contiguous arrays.
+     * Discounts are interpolated linearly on the log discount factors, as PiecewiseCurve<Discount, LogLinear>,
+     * and extrapolated with the first and last segments (flat forward after the last node). Curves that the
+     * nodes do not reproduce (other traits or interpolations, flat forwards with simple rates) are compiled
+     * to a frozen copy instead, a read-only QuantLib curve over the same nodes or parameters that discounts
+     * go through; the arrays then only describe its nodes. Like the curve it was compiled from, it throws past
+     * the curve max time unless extrapolation is enabled on that curve.
+     */
+    class CompiledCurve {
+       public:
+        CompiledCurve(const Date& referenceDate, const DayCounter& dayCounter, std::vector<double> times, std::vector<double> logDiscounts);
+        // discount and flat forward curves, and the curves restored from saved piecewise curves
+        explicit CompiledCurve(const boost::shared_ptr<YieldTermStructure>& curve);
+        explicit CompiledCurve(const BootstrappedCurve& curve);
+
+        static bool isSupported(const boost::shared_ptr<YieldTermStructure>& curve);
+        static bool isSupported(const BootstrappedCurve& curve);
+        // discount curves, and flat forward curves with continuous or compounded rates, which compile to nodes
+        static bool isLogLinear(const boost::shared_ptr<YieldTermStructure>& curve);
+
+        bool isFrozenCopy() const {
+            return frozen_ != nullptr;
+        };
+
+        const Date& referenceDate() const {
+            return referenceDate_;
+        };
+        const DayCounter& dayCounter() const {
+            return dayCounter_;
+        };
+        const std::vector<double>& times() const {
+            return times_;
+        };
+        const std::vector<double>& logDiscounts() const {
+            return logDiscounts_;
+        };
+        bool allowsExtrapolation() const {
+            return allowsExtrapolation_;
+        };
+        Time maxTime() const {
+            return maxTime_;
+        };
+
+        Time timeFromReference(const Date& date) const {
+            return dayCounter_.yearFraction(referenceDate_, date);
+        };
+
+        double discount(Time t) const {
+            QL_REQUIRE(allowsExtrapolation_ || t <= maxTime_ || close_enough(t, maxTime_),
+                       "time (" << t << ") is past max curve time (" << maxTime_ << ")");
+            if (frozen_) return frozen_->discount(t, true);
+            const double* x = times_.data();
+            size_t i        = std::upper_bound(x + 1, x + times_.size() - 1, t) - x - 1;
+            return std::exp(logDiscounts_[i] + slopes_[i] * (t - x[i]));
+        };
+
+        void discounts(const Time* times, size_t n, double* out) const;
+        void discounts(const Date::serial_type* dates, size_t n, double* out) const;
+
+       private:
+        void computeSlopes();
+        void copyRange(const YieldTermStructure& curve);
+
+        Date referenceDate_;
+        DayCounter dayCounter_;
+        std::vector<double> times_;
+        std::vector<double> logDiscounts_;
+        std::vector<double> slopes_;
+        bool allowsExtrapolation_ = true;
+        Time maxTime_             = QL_MAX_REAL;
+        boost::shared_ptr<const YieldTermStructure> frozen_;
+    };
+
+    /*
+     * Immutable set of compiled curves taken from a MarketStore. Once built it is only read, so it can
+     * be queried from any number of threads without locking. Each snapshot is an epoch of the store.
+     */
+    class CurveSnapshot {
+       public:
+        CurveSnapshot() = default;
+        explicit CurveSnapshot(const MarketStore& marketStore, uint64_t epoch = 0);
+        // compiles only the changed curves and shares the rest with the previous epoch
+        CurveSnapshot(const MarketStore& marketStore, const CurveSnapshot& previous, const std::vector<std::string>& changedCurves);
+
+        uint64_t epoch() const {
+            return epoch_;
+        };
+
+        // curves are indexed by the CurveId of the store they were compiled from
+        bool hasCurve(CurveId id) const {
+            return id < curves_.size() && curves_[id];
+        };
+        bool hasCurve(const std::string& name) const;
+        CurveId curveId(const std::string& name) const;
+        const CompiledCurve& curve(CurveId id) const {
+            return *curves_[id];
+        };
+        const CompiledCurve& curve(const std::string& name) const;
+        std::vector<std::string> allCurves() const;
+
+       private:
+        void addCurve(CurveId id, const std::string& name, std::shared_ptr<const CompiledCurve> curve);
+
+        uint64_t epoch_ = 0;
+        std::vector<std::shared_ptr<const CompiledCurve>> curves_;
+        std::vector<std::string> names_;
+        std::unordered_map<std::string, CurveId> ids_;
+    };
+
+    /*
+     * Pins an epoch of a MarketStore: the snapshot stays alive, and unchanged, for as long as a handle
+     * refers to it, and is freed when the last handle is released. Copies are cheap.
+     */
+    class EpochHandle {
+       public:
+        EpochHandle() = default;
+        explicit EpochHandle(std::shared_ptr<const CurveSnapshot> snapshot) : snapshot_(std::move(snapshot)){};
+
+        bool empty() const {
+            return !snapshot_;
+        };
+        uint64_t epoch() const {
+            return snapshot_->epoch();
+        };
+        const CurveSnapshot& operator*() const {
+            return *snapshot_;
+        };
+        const CurveSnapshot* operator->() const {
+            return snapshot_.get();
+        };
+
+       private:
+        std::shared_ptr<const CurveSnapshot> snapshot_;
+    };
+}  // namespace CurveManager
+
+#endif /* C8DA981B_4D89_45DF_BA87_6148E0777E2A */
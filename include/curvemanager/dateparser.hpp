@@ -0,0 +1,32 @@
+#ifndef ACE7C0D9_F231_4C9E_A480_8E4B626540F5
+#define ACE7C0D9_F231_4C9E_A480_8E4B626540F5
+
+#include <ql/time/date.hpp>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+    using json = nlohmann::json;
+
+    // fixed format DDMMYYYY, without going through QuantLibParser; parse returns false for any other input
+    bool parseDDMMYYYY(const char* data, size_t size, Date& date);
+    std::string formatDDMMYYYY(const Date& date);
+    // writes the 8 characters of formatDDMMYYYY to out
+    void writeDDMMYYYY(const Date& date, char* out);
+
+    /*
+     * Request date parsing and response date formatting. DDMMYYYY strings take the fixed format path; any
+     * other format goes to QuantLibParser's parse<Date> once and is then served from a cache. Dates are
+     * formatted as QuantLibParser's DateFormat::MIXED, cached by serial number. Caches are per thread (no
+     * locking) and bounded: a cache is cleared when it reaches dateCacheSize entries.
+     */
+    constexpr size_t dateCacheSize = 16384;
+
+    Date cachedParseDate(const std::string& date);
+    Date cachedParseDate(const json& date);
+    std::string cachedFormatDate(const Date& date);
+}  // namespace CurveManager
+
+#endif /* ACE7C0D9_F231_4C9E_A480_8E4B626540F5 */
@@ -0,0 +1,107 @@
+#ifndef A26DBAE6_8F5B_4B01_AABC_2C44D278B350
+#define A26DBAE6_8F5B_4B01_AABC_2C44D278B350
+
+#include <ql/time/date.hpp>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+    using json = nlohmann::json;
+
+    // wire encodings of the query endpoints; the names are JSON, CBOR, MSGPACK and COLUMNAR
+    enum class Encoding
+    {
+        JSON,
+        CBOR,
+        MessagePack,
+        Columnar
+    };
+
+    Encoding parseEncoding(const std::string& name);
+
+    /*
+     * Whole documents (requests or responses) in the tree encodings, through nlohmann's own CBOR and
+     * MessagePack support. Columnar has no tree form: see ColumnarQuery and ResponseEncoder.
+     */
+    std::vector<uint8_t> encodeDocument(const json& document, Encoding encoding);
+    json decodeDocument(const uint8_t* data, size_t size, Encoding encoding);
+
+    /*
+     * Columnar discount, zero rate or forward rate request, little endian: the "CMCQ" magic, the curve, day
+     * counter, compounding and frequency as uint32 length prefixed strings (empty for the request defaults), a
+     * uint32 count and the dates as int32 serial numbers. A forward request follows them with the end dates,
+     * as many as the start dates held in dates.
+     */
+    struct ColumnarQuery {
+        std::string curve;
+        std::string dayCounter;
+        std::string compounding;
+        std::string frequency;
+        std::vector<Date::serial_type> dates;
+        std::vector<Date::serial_type> endDates;  // forward requests only
+    };
+
+    std::vector<uint8_t> encodeColumnarQuery(const ColumnarQuery& query);
+    ColumnarQuery decodeColumnarQuery(const uint8_t* data, size_t size);
+
+    /*
+     * Columnar response, little endian: the "CMCR" magic, a uint32 count, the values as float64 and the dates
+     * as int32 serial numbers (the values are 8 byte aligned in an aligned buffer).
+     */
+    void decodeColumnarResponse(const uint8_t* data, size_t size, std::vector<Date::serial_type>& dates, std::vector<double>& values);
+
+    /*
+     * Columnar forward rate response, little endian: the "CMCF" magic, a uint32 count, the values as float64,
+     * then the start and the end dates as int32 serial numbers.
+     */
+    void decodeColumnarForwardResponse(const uint8_t* data,
+                                       size_t size,
+                                       std::vector<Date::serial_type>& startDates,
+                                       std::vector<Date::serial_type>& endDates,
+                                       std::vector<double>& values);
+
+    /*
+     * Writes the responses of the discount and zero rate requests straight into a buffer kept across calls,
+     * without building a json tree. In JSON, CBOR and MessagePack the document is the one of the json
+     * endpoints, [{"DATE": "DDMMYYYY", "VALUE": value}, ...], with the dates always in DDMMYYYY; Columnar
+     * is the layout of decodeColumnarResponse. The forward rate overload writes the document of
+     * forwardRateRequest, {"DATES": [["DDMMYYYY", "DDMMYYYY"], ...], "VALUES": [value, ...]}, or the layout
+     * of decodeColumnarForwardResponse. The buffer is overwritten by the next encode.
+     */
+    class ResponseEncoder {
+       public:
+        explicit ResponseEncoder(Encoding encoding = Encoding::JSON) : encoding_(encoding){};
+
+        Encoding encoding() const {
+            return encoding_;
+        };
+        void setEncoding(Encoding encoding) {
+            encoding_ = encoding;
+        };
+
+        const std::vector<uint8_t>& encode(const Date::serial_type* dates, const double* values, size_t n);
+        const std::vector<uint8_t>& encode(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n);
+        const std::vector<uint8_t>& buffer() const {
+            return buffer_;
+        };
+
+       private:
+        void encodeJSON(const Date::serial_type* dates, const double* values, size_t n);
+        void encodeCBOR(const Date::serial_type* dates, const double* values, size_t n);
+        void encodeMessagePack(const Date::serial_type* dates, const double* values, size_t n);
+        void encodeColumnar(const Date::serial_type* dates, const double* values, size_t n);
+        void encodeForwardJSON(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n);
+        void encodeForwardCBOR(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n);
+        void encodeForwardMessagePack(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n);
+        void encodeForwardColumnar(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n);
+
+        Encoding encoding_;
+        std::vector<uint8_t> buffer_;
+    };
+}  // namespace CurveManager
+
+#endif /* A26DBAE6_8F5B_4B01_AABC_2C44D278B350 */
@@ -0,0 +1,70 @@
+#ifndef BED2CFE6_005A_4EFC_B838_663F2DFF67EB
+#define BED2CFE6_005A_4EFC_B838_663F2DFF67EB
+
+#include <ql/settings.hpp>
+#include <ql/timeseries.hpp>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    /*
+     * True when QuantLib was built with QL_ENABLE_SESSIONS and curvemanager with CURVEMANAGER_SESSIONS, which
+     * defines QuantLib::sessionId() as the calling thread. Settings (and so the evaluation date) and
+     * IndexManager are then kept per thread and builders for different dates run fully in parallel.
+     */
+    bool hasThreadLocalSettings();
+
+    /*
+     * Scoped hold on the evaluation date of QuantLib's Settings. With process wide Settings, holders of the same
+     * date share it (bootstraps, quote updates), while exclusive holders (anything that constructs or destroys
+     * QuantLib objects, which registers observers on the evaluation date) run alone; a hold for another date
+     * waits until the current ones are released. With per thread Settings it only sets the date of the thread.
+     * Holds are reentrant on a thread as long as the date does not change and a shared hold is not made
+     * exclusive (the default hold included), which throws.
+     */
+    class EvaluationDateLock {
+       public:
+        enum class Mode
+        {
+            Shared,
+            Exclusive
+        };
+
+        explicit EvaluationDateLock(const Date& date, Mode mode = Mode::Shared);
+        // exclusive hold that keeps the current date, for the destruction of QuantLib objects
+        EvaluationDateLock();
+        ~EvaluationDateLock();
+
+        EvaluationDateLock(const EvaluationDateLock&)            = delete;
+        EvaluationDateLock& operator=(const EvaluationDateLock&) = delete;
+
+        /*
+         * What worker threads started by a holder take from it: the date and, with per thread Settings, the
+         * fixings of the holder thread, since IndexManager is then per thread too. Captured on the holder
+         * thread with capture and applied at the start of each worker task with inherit; with process wide
+         * Settings the holder already owns the date and the fixings, and both do nothing.
+         */
+        struct Context {
+            Date date;
+            uint64_t id = 0;
+            std::vector<std::pair<std::string, TimeSeries<Real>>> fixings;
+        };
+
+        static Context capture(const Date& date);
+        static void inherit(const Context& context);
+
+       private:
+        void acquire(const Date& date, Mode mode, bool keepDate);
+
+        Mode mode_;
+        bool owner_  = false;  // took the process wide hold
+        bool nested_ = false;  // inside a hold of the same thread
+    };
+}  // namespace CurveManager
+
+#endif /* BED2CFE6_005A_4EFC_B838_663F2DFF67EB */
@@ -0,0 +1,34 @@
+#ifndef FAC11EFD_3D7D_4034_B101_BD5E5810FD02
+#define FAC11EFD_3D7D_4034_B101_BD5E5810FD02
+
+#include <ql/time/date.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    // fixings of one index, as parallel columns of dates and values
+    struct FixingSeries {
+        std::vector<Date> dates;
+        std::vector<double> values;
+    };
+
+    // fixing series by index name
+    using FixingsTable = std::unordered_map<std::string, FixingSeries>;
+
+    /*
+     * Columnar fixings files. The CSV has a DATE,<INDEX>,<INDEX>,... header and one row per DDMMYYYY date,
+     * with an empty cell where an index has no fixing. The binary format (writeFixingsBinary) holds, per
+     * index, its name and contiguous arrays of date serial numbers and values. Both are memory mapped;
+     * readFixings tells them apart by the magic number at the start of the binary files.
+     */
+    FixingsTable readFixings(const std::string& path);
+    FixingsTable readFixingsCSV(const std::string& path);
+    FixingsTable readFixingsBinary(const std::string& path);
+    void writeFixingsBinary(const std::string& path, const FixingsTable& fixings);
+}  // namespace CurveManager
+
+#endif /* FAC11EFD_3D7D_4034_B101_BD5E5810FD02 */
@@ -0,0 +1,75 @@
+#ifndef AC827DA1_B03E_46E2_B70D_7F72E00B0915
+#define AC827DA1_B03E_46E2_B70D_7F72E00B0915
+
+#include <curvemanager/curvemanager.hpp>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace CurveManager
+{
+    /*
+     * Quotes by date and fixings by index of a market history. CSV files have one DATE,TICKER,VALUE (quotes) or
+     * DATE,INDEX,VALUE (fixings) row per value, dates as DDMMYYYY and an optional header row; the binary format
+     * (see saveBinary) holds the same data columnar and is memory mapped on load.
+     */
+    struct MarketHistory {
+        std::map<Date, std::unordered_map<std::string, double>> quotes;
+        std::unordered_map<std::string, std::map<Date, double>> fixings;
+
+        static MarketHistory fromCSV(const std::string& quotesPath, const std::string& fixingsPath = "");
+        static MarketHistory fromBinary(const std::string& path);
+        void saveBinary(const std::string& path) const;
+        std::vector<Date> dates() const;
+    };
+
+    /*
+     * Rebuilds a curve config for every date of a market history: each day gets its own MarketStore and
+     * CurveBuilder, with the config's REFDATE and quotes replaced by the day's (tickers missing on a day keep
+     * the config value). The nodes of the bootstrapped curves are appended to the output file as each day
+     * finishes, so only the days in flight are held in memory.
+     *
+     * Days run on a pool of nThreads workers only when QuantLib keeps its Settings per thread
+     * (hasThreadLocalSettings, see CURVEMANAGER_SESSIONS). With process wide Settings every day needs the
+     * evaluation date for itself, so the days run one after the other on the calling thread and nThreads is
+     * ignored.
+     */
+    class HistoryEngine {
+       public:
+        HistoryEngine(const json& config, const MarketHistory& history, size_t nThreads = 0);
+
+        /*
+         * Writes the nodes of the given dates (all the dates of the history by default) to path and returns
+         * the number of days written. A day that fails to build is skipped and its error kept in errors().
+         */
+        size_t run(const std::string& path);
+        size_t run(const std::string& path, const std::vector<Date>& dates);
+        const std::map<Date, std::string>& errors() const;
+
+        using NodeVisitor =
+            std::function<void(const Date& refDate, const std::string& curve, const std::vector<Date>& dates, const std::vector<double>& discounts)>;
+        // reads back a file written by run, in the order the days were written
+        static void readNodes(const std::string& path, const NodeVisitor& visitor);
+
+       private:
+        struct CurveNodes {
+            std::string name;
+            std::vector<Date::serial_type> dates;
+            std::vector<double> values;
+        };
+
+        std::vector<CurveNodes> buildDay(const Date& refDate);
+        void loadFixings(MarketStore& store, const Date& refDate);
+
+        json config_;
+        const MarketHistory& history_;
+        size_t nThreads_;
+        uint64_t runId_                  = 0;
+        std::atomic<bool> fixingsLoaded_ = false;
+        std::map<Date, std::string> errors_;
+        std::mutex mutex_;
+    };
+}  // namespace CurveManager
+
+#endif /* AC827DA1_B03E_46E2_B70D_7F72E00B0915 */
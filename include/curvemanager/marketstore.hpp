@@ -2,12 +2,20 @@
 #ifndef BAB0CCE6_F3E6_4E00_8FCE_23361591F7DF
 #define BAB0CCE6_F3E6_4E00_8FCE_23361591F7DF
 
+#include <curvemanager/bootstrappedcurve.hpp>
+#include <curvemanager/encoding.hpp>
+#include <curvemanager/fixings.hpp>
+#include <curvemanager/metrics.hpp>
+#include <curvemanager/symboltable.hpp>
 #include <ql/handle.hpp>
 #include <ql/indexes/iborindex.hpp>
+#include <ql/math/matrix.hpp>
 #include <ql/quote.hpp>
 #include <ql/termstructures/yield/piecewiseyieldcurve.hpp>
 #include <ql/termstructures/yieldtermstructure.hpp>
+#include <deque>
 #include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <unordered_map>
 
@@ -16,9 +24,23 @@ namespace CurveManager
     using namespace QuantLib;
     using json = nlohmann::json;
 
+    class CurveSnapshot;
+    class EpochHandle;
+
+    /*
+     * Sensitivities of the bootstrapped discount factors of a curve to the quotes of its own rate helpers:
+     * values[j][i] is the derivative of the discount at dates[j] with respect to the quote tickers[i].
+     */
+    struct CurveJacobian {
+        std::vector<Date> dates;
+        std::vector<std::string> tickers;
+        Matrix values;
+    };
+
     class MarketStore {
        public:
         MarketStore();
+        ~MarketStore();
 
         bool hasCurveHandle(const std::string& name) const;
         bool hasCurve(const std::string& name) const;
@@ -30,29 +52,206 @@ namespace CurveManager
         Handle<Quote>& getQuote(const std::string& ticker);
         RelinkableHandle<YieldTermStructure>& getCurveHandle(const std::string& name);
 
+        /*
+         * Curve names and quote tickers are interned into dense ids when their handle or quote is first added;
+         * ids are never reused, so clients on the hot paths can resolve names once and then use the id
+         * overloads, which index flat storage instead of hashing the strings.
+         */
+        CurveId curveId(const std::string& name) const;
+        QuoteId quoteId(const std::string& ticker) const;
+        const std::string& curveName(CurveId id) const;
+        const std::string& quoteTicker(QuoteId id) const;
+        size_t curveIdCount() const;
+        size_t quoteIdCount() const;
+
+        bool hasCurve(CurveId id) const;
+        boost::shared_ptr<YieldTermStructure> getCurve(CurveId id) const;
+        Handle<Quote>& getQuote(QuoteId id);
+
+        // piecewise curve behind a built curve; empty for curves that are not bootstrapped
+        const BootstrappedCurve& getBootstrappedCurve(const std::string& name) const;
+        const BootstrappedCurve& getBootstrappedCurve(CurveId id) const;
+
         void addFixing(const std::string& name, const Date& date, double fixing);
+        /*
+         * Bulk fixings: each series is added to its index in one operation (one copy of the index history and
+         * one notification, where addFixing pays both per fixing). Every index is checked to exist before any
+         * fixing is added. loadFixings reads a columnar CSV or binary file (see readFixings). Both return the
+         * number of fixings added.
+         */
+        size_t addFixings(const std::string& name, const std::vector<Date>& dates, const std::vector<double>& values);
+        size_t addFixings(const FixingsTable& fixings);
+        size_t loadFixings(const std::string& path);
         void addCurve(const std::string& name, boost::shared_ptr<YieldTermStructure>& curve);
+        void addCurve(const std::string& name, const BootstrappedCurve& curve);
         void addIndex(const std::string& name, boost::shared_ptr<IborIndex>& index);
         void addQuote(const std::string& ticker, Handle<Quote>& handle);
         void addCurveHandle(const std::string& name, RelinkableHandle<YieldTermStructure>& handle);
+        // the curve handle is kept, so that it can be relinked by the next build, and so are the nodes of a piecewise curve
+        void removeCurve(const std::string& name);
+        // nodes of the last removed piecewise curve of that name (null if none), the seed of its warm started rebuild
+        boost::shared_ptr<const CurveSeed> curveSeed(const std::string& name) const;
 
         void freeze();
         void unfreeze();
+        void freeze(const std::vector<std::string>& names);
+        void unfreeze(const std::vector<std::string>& names);
+        void recalculate(const std::vector<std::string>& names);
 
         std::vector<std::string> allCurves() const;
         std::vector<std::string> allIndexes() const;
+        std::vector<std::string> allQuotes() const;
 
         json bootstrapResults() const;
 
+        /*
+         * Instrumentation of the store and of the builders working on it: latency histograms per query
+         * endpoint, schema validation and quote update times, and per curve bootstrap statistics. Only
+         * filled in when built with CURVEMANAGER_METRICS.
+         */
+        json metrics() const;
+        std::string prometheusMetrics() const;
+        MetricsRegistry& metricsRegistry() const;
+
+        bool hasJacobian(const std::string& name) const;
+        const CurveJacobian& getJacobian(const std::string& name) const;
+        void addJacobian(const std::string& name, const CurveJacobian& jacobian);
+
+        /*
+         * Compiles the current curves into a new CurveSnapshot (the next epoch) and swaps it in atomically.
+         * Readers holding a previous epoch keep using it until they release it. The overload taking the
+         * changed curves recompiles only those and shares the others with the previous epoch. Only one
+         * thread may publish at a time.
+         */
+        uint64_t publishSnapshot();
+        uint64_t publishSnapshot(const std::vector<std::string>& changedCurves);
+        std::shared_ptr<const CurveSnapshot> snapshot() const;
+        EpochHandle pin() const;
+
+        /*
+         * In versioned mode CurveBuilder publishes an epoch after every build and quote update, and the
+         * batch and request queries read the curves of the current epoch instead of the live ones. Once an
+         * epoch is published, queries on a curve it could not compile (a curve added to the store that is
+         * neither piecewise, discount nor flat forward) throw instead of reading the live curve.
+         */
+        void setVersioned(bool versioned);
+        bool isVersioned() const;
+
+        // trusted input skips the schema validation of requests, quote updates and the configs of the builders
+        // constructed on the store (defaults are still filled in)
+        void setTrustedInput(bool trusted);
+        bool isTrustedInput() const;
+
+        /*
+         * Batch queries over contiguous arrays of dates (as serial numbers) or times. Results are
+         * written to out, which must hold n values.
+         */
+        void discounts(const std::string& curve, const Date::serial_type* dates, size_t n, double* out) const;
+        void discounts(const std::string& curve, const Time* times, size_t n, double* out) const;
+        void zeroRates(const std::string& curve,
+                       const Date::serial_type* dates,
+                       size_t n,
+                       const DayCounter& dayCounter,
+                       Compounding comp,
+                       Frequency freq,
+                       double* out) const;
+        void forwardRates(const std::string& curve,
+                          const Date::serial_type* startDates,
+                          const Date::serial_type* endDates,
+                          size_t n,
+                          const DayCounter& dayCounter,
+                          Compounding comp,
+                          Frequency freq,
+                          double* out) const;
+
+        void discounts(CurveId curve, const Date::serial_type* dates, size_t n, double* out) const;
+        void discounts(CurveId curve, const Time* times, size_t n, double* out) const;
+        void zeroRates(CurveId curve,
+                       const Date::serial_type* dates,
+                       size_t n,
+                       const DayCounter& dayCounter,
+                       Compounding comp,
+                       Frequency freq,
+                       double* out) const;
+        void forwardRates(CurveId curve,
+                          const Date::serial_type* startDates,
+                          const Date::serial_type* endDates,
+                          size_t n,
+                          const DayCounter& dayCounter,
+                          Compounding comp,
+                          Frequency freq,
+                          double* out) const;
+
         json discountRequest(const json& request) const;
         json zeroRateRequest(const json& request) const;
         json forwardRateRequest(const json& request) const;
+        json jacobianRequest(const json& request) const;
+
+        /*
+         * The discount, zero rate and forward rate requests in other encodings: the request is decoded from
+         * encoding (the JSON request in JSON, CBOR or MessagePack, a ColumnarQuery in Columnar) and the
+         * response is written by encoder, in its own encoding, into its buffer, which is returned. Columnar
+         * queries get the same checks as the JSON ones, unless the input is trusted.
+         */
+        const std::vector<uint8_t>& discountRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const;
+        const std::vector<uint8_t>& zeroRateRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const;
+        const std::vector<uint8_t>& forwardRateRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const;
 
        private:
-        std::unordered_map<std::string, boost::shared_ptr<YieldTermStructure>> curveMap_;
-        std::unordered_map<std::string, RelinkableHandle<YieldTermStructure>> curveHandleMap_;
-        std::unordered_map<std::string, boost::shared_ptr<IborIndex>> indexMap_;
-        std::unordered_map<std::string, Handle<Quote>> quoteMap_;
+        // the caller holds the evaluation date lock
+        size_t addFixingsUnlocked(IborIndex& index, const std::vector<Date>& dates, const std::vector<double>& values);
+        // validated request with its defaults, and its dates and results
+        json discountQuery(const json& request, std::vector<Date::serial_type>& dates, std::vector<double>& values) const;
+        json zeroRateQuery(const json& request, std::vector<Date::serial_type>& dates, std::vector<double>& values) const;
+        json forwardRateQuery(const json& request,
+                              std::vector<Date::serial_type>& startDates,
+                              std::vector<Date::serial_type>& endDates,
+                              std::vector<double>& values) const;
+        std::shared_ptr<const CurveSnapshot> versionedSnapshot(CurveId curve) const;
+        /*
+         * The batch queries on an epoch, or on the live curve when snapshot is null. They are not timed, so
+         * that each public query and request records one sample, in its own histogram.
+         */
+        void discountsOn(const CurveSnapshot* snapshot, CurveId curve, const Date::serial_type* dates, size_t n, double* out) const;
+        void discountsOn(const CurveSnapshot* snapshot, CurveId curve, const Time* times, size_t n, double* out) const;
+        void zeroRatesOn(const CurveSnapshot* snapshot,
+                         CurveId curve,
+                         const Date::serial_type* dates,
+                         size_t n,
+                         const DayCounter& dayCounter,
+                         Compounding comp,
+                         Frequency freq,
+                         double* out) const;
+        void forwardRatesOn(const CurveSnapshot* snapshot,
+                            CurveId curve,
+                            const Date::serial_type* startDates,
+                            const Date::serial_type* endDates,
+                            size_t n,
+                            const DayCounter& dayCounter,
+                            Compounding comp,
+                            Frequency freq,
+                            double* out) const;
+
+        struct CurveSlot {
+            boost::shared_ptr<YieldTermStructure> curve;  // null until built, or after removeCurve
+            BootstrappedCurve bootstrapped;               // same curve, for piecewise curves
+            RelinkableHandle<YieldTermStructure> handle;
+            boost::shared_ptr<const CurveSeed> seed;
+            bool hasHandle = false;
+        };
+
+        // deques, so that references returned by getCurveHandle and getQuote survive later insertions
+        SymbolTable curveSymbols_;
+        SymbolTable indexSymbols_;
+        SymbolTable quoteSymbols_;
+        std::deque<CurveSlot> curves_;
+        std::vector<boost::shared_ptr<IborIndex>> indexes_;
+        std::deque<Handle<Quote>> quotes_;
+        std::unordered_map<std::string, CurveJacobian> jacobianMap_;
+        std::shared_ptr<const CurveSnapshot> snapshot_;
+        mutable MetricsRegistry metricsRegistry_;
+        bool versioned_    = false;
+        bool trustedInput_ = false;
     };
 
 };  // namespace CurveManager
@@ -0,0 +1,150 @@
+#ifndef EF60B6CC_91D7_4CCD_8A4C_FBD6795D0C84
+#define EF60B6CC_91D7_4CCD_8A4C_FBD6795D0C84
+
+#include <ql/quotes/simplequote.hpp>
+#include <boost/make_shared.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Instrumentation is compiled in when CURVEMANAGER_METRICS is defined (CMake option CURVEMANAGER_METRICS).
+ * Without it the timing macros expand to nothing, store quotes are plain SimpleQuotes and the registry
+ * stays empty, so the hot paths carry no extra work.
+ */
+
+namespace CurveManager
+{
+    using json = nlohmann::json;
+
+    // timed operations, each with its own latency histogram
+    enum class Timing : size_t
+    {
+        DiscountRequest = 0,
+        ZeroRateRequest,
+        ForwardRateRequest,
+        JacobianRequest,
+        Discounts,
+        ZeroRates,
+        ForwardRates,
+        QuoteUpdate,
+        RequestValidation,
+        CurveConfigValidation,
+        QuoteUpdateValidation,
+        Count
+    };
+
+    /*
+     * Lock free latency histogram with power of two buckets: bucket i counts the samples of at most 2^i
+     * microseconds, the last one everything above.
+     */
+    class LatencyHistogram {
+       public:
+        static constexpr size_t nBuckets = 24;
+
+        void record(double micros);
+        void reset();
+
+        uint64_t count() const;
+        double sum() const;  // in microseconds
+        uint64_t bucketCount(size_t i) const;
+        static double bucketBound(size_t i);  // in microseconds, infinity for the last bucket
+
+       private:
+        std::array<std::atomic<uint64_t>, nBuckets> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sumNanos_{0};
+    };
+
+    // last bootstrap of a curve, plus running totals
+    struct CurveMetrics {
+        double lastBootstrapMs    = 0.0;
+        double totalBootstrapMs   = 0.0;
+        uint64_t bootstraps       = 0;
+        uint64_t solverIterations = 0;
+        size_t helpers            = 0;
+    };
+
+    class MetricsRegistry {
+       public:
+        LatencyHistogram& histogram(Timing timing) {
+            return histograms_[static_cast<size_t>(timing)];
+        };
+
+        /*
+         * Solver iterations are counted as evaluations of the bootstrap objective, i.e. reads of the
+         * helper quotes during the bootstrap (see CountingQuote).
+         */
+        void recordBootstrap(const std::string& curve, double elapsedMs, uint64_t solverIterations, size_t helpers);
+        CurveMetrics curveMetrics(const std::string& curve) const;
+        void reset();
+
+        json toJSON() const;
+        std::string toPrometheus() const;
+
+       private:
+        std::array<LatencyHistogram, static_cast<size_t>(Timing::Count)> histograms_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, CurveMetrics> curves_;
+    };
+
+    // records the lifetime of the scope, in microseconds, into a histogram
+    class ScopeTimer {
+       public:
+        explicit ScopeTimer(LatencyHistogram& histogram) : histogram_(histogram), start_(std::chrono::steady_clock::now()){};
+        ~ScopeTimer() {
+            histogram_.record(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count());
+        };
+
+        ScopeTimer(const ScopeTimer&)            = delete;
+        ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+       private:
+        LatencyHistogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /*
+     * SimpleQuote that counts how many times it is read. Rate helpers read their quote once per evaluation
+     * of the bootstrap objective, so the count over a bootstrap gives the solver iterations.
+     */
+    class CountingQuote : public QuantLib::SimpleQuote {
+       public:
+        explicit CountingQuote(QuantLib::Real value) : QuantLib::SimpleQuote(value){};
+        QuantLib::Real value() const override {
+            reads_.fetch_add(1, std::memory_order_relaxed);
+            return QuantLib::SimpleQuote::value();
+        };
+        uint64_t reads() const {
+            return reads_.load(std::memory_order_relaxed);
+        };
+
+       private:
+        mutable std::atomic<uint64_t> reads_{0};
+    };
+
+    // quote type held by the store
+    inline boost::shared_ptr<QuantLib::SimpleQuote> makeStoreQuote(QuantLib::Real value) {
+#ifdef CURVEMANAGER_METRICS
+        return boost::make_shared<CountingQuote>(value);
+#else
+        return boost::make_shared<QuantLib::SimpleQuote>(value);
+#endif
+    }
+}  // namespace CurveManager
+
+#define CURVEMANAGER_CONCAT_IMPL(a, b) a##b
+#define CURVEMANAGER_CONCAT(a, b) CURVEMANAGER_CONCAT_IMPL(a, b)
+
+#ifdef CURVEMANAGER_METRICS
+#define CURVEMANAGER_TIME_SCOPE(registry, timing) \
+    ::CurveManager::ScopeTimer CURVEMANAGER_CONCAT(scopeTimer_, __LINE__)((registry).histogram(timing))
+#else
+#define CURVEMANAGER_TIME_SCOPE(registry, timing) ((void)0)
+#endif
+
+#endif /* EF60B6CC_91D7_4CCD_8A4C_FBD6795D0C84 */
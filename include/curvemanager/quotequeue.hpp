@@ -0,0 +1,166 @@
+#ifndef BF2C1BBF_B182_4FF6_9E9A_27CB7E4E3D96
+#define BF2C1BBF_B182_4FF6_9E9A_27CB7E4E3D96
+
+#include <curvemanager/curvemanager.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace CurveManager
+{
+    /*
+     * Bounded lock free multi producer queue (Vyukov's sequence numbered ring). push fails instead of
+     * blocking when the ring is full.
+     */
+    template <typename T>
+    class BoundedQueue {
+       public:
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            mask_  = size - 1;
+            cells_ = std::make_unique<Cell[]>(size);
+            for (size_t i = 0; i < size; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        };
+
+        bool push(const T& value) {
+            Cell* cell;
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell          = &cells_[pos & mask_];
+                size_t seq    = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = value;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        };
+
+        bool pop(T& value) {
+            Cell* cell;
+            size_t pos = head_.load(std::memory_order_relaxed);
+            for (;;) {
+                cell          = &cells_[pos & mask_];
+                size_t seq    = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+            value = cell->value;
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        };
+
+       private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_;
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) std::atomic<size_t> head_{0};
+    };
+
+    struct QuoteQueueStats {
+        size_t depth       = 0;  // tickers waiting for the next batch
+        uint64_t received  = 0;
+        uint64_t coalesced = 0;  // ticks that overwrote a pending tick of the same ticker
+        uint64_t dropped   = 0;  // ticks for unknown tickers, non finite values, or lost in a failed batch
+        uint64_t applied   = 0;
+        uint64_t batches   = 0;
+    };
+
+    /*
+     * Ingestion queue for market data ticks. push is lock free and may be called from any number of feed
+     * threads: the last value of each ticker is kept in a slot and the ticker is queued once until the next
+     * batch, so bursts on the same ticker coalesce. Batches go through CurveBuilder::updateQuotes, i.e. one
+     * freeze/set/recalculate cycle per batch, either on the calling thread (flush) or on a background thread
+     * started with start(), which applies a batch every interval or as soon as maxBatch tickers are pending.
+     *
+     * Only the quotes present in the store when the queue is created are accepted. The background thread
+     * updates the curves while other threads may be querying them: use a versioned store in that case.
+     */
+    class QuoteQueue {
+       public:
+        QuoteQueue(CurveBuilder& builder,
+                   MarketStore& marketStore,
+                   size_t maxBatch                    = 256,
+                   std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+        ~QuoteQueue();
+
+        QuoteQueue(const QuoteQueue&)            = delete;
+        QuoteQueue& operator=(const QuoteQueue&) = delete;
+
+        // returns false if the tick was dropped
+        bool push(const std::string& ticker, double value);
+        bool push(QuoteId quote, double value);
+
+        // applies the pending ticks as one batch and returns the number of quotes updated
+        size_t flush();
+
+        void start();
+        // stops the background thread, applying whatever is still pending
+        void stop();
+        bool isRunning() const;
+
+        /*
+         * Pushes the ticks of a file with one JSON object per line, {"NAME": ticker, "VALUE": value}, in
+         * place of the live feed. Returns the number of lines read.
+         */
+        size_t replay(const std::string& path);
+
+        QuoteQueueStats stats() const;
+
+       private:
+        struct Slot {
+            std::atomic<double> value{0.0};
+            std::atomic<bool> pending{false};
+        };
+
+        void run();
+
+        CurveBuilder& builder_;
+        std::unordered_map<std::string, QuoteId> quoteIds_;  // fixed at construction, read without locks
+        size_t nQuotes_;
+        std::unique_ptr<Slot[]> slots_;  // indexed by QuoteId
+        BoundedQueue<QuoteId> ready_;
+        size_t maxBatch_;
+        std::chrono::milliseconds interval_;
+
+        std::atomic<size_t> depth_{0};
+        std::atomic<uint64_t> received_{0};
+        std::atomic<uint64_t> coalesced_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> applied_{0};
+        std::atomic<uint64_t> batches_{0};
+
+        std::mutex flushMutex_;
+        mutable std::mutex wakeMutex_;
+        std::condition_variable wake_;
+        std::thread worker_;
+        bool running_ = false;
+    };
+}  // namespace CurveManager
+
+#endif /* BF2C1BBF_B182_4FF6_9E9A_27CB7E4E3D96 */
@@ -0,0 +1,48 @@
+#ifndef F1716D19_273A_495D_9BF1_5312E1325C7F
+#define F1716D19_273A_495D_9BF1_5312E1325C7F
+
+#include <ql/compounding.hpp>
+#include <ql/time/frequency.hpp>
+#include <cmath>
+#include <cstddef>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    /*
+     * Converts discount factors to zero rates in the given compounding. times are the year fractions
+     * between the reference date and each date, measured with the requested day counter; dfs and
+     * times must not alias out. Returns false if the compounding is not supported by the kernel, and for
+     * the inputs InterestRate rejects (a compounded rate without a frequency, a time that is not positive),
+     * so that the caller falls back to InterestRate::impliedRate and gets its error.
+     */
+    inline bool zeroRatesFromDiscounts(const double* dfs, const double* times, size_t n, Compounding comp, Frequency freq, double* out) {
+        if ((comp == Compounded || comp == SimpleThenCompounded) && (freq == NoFrequency || freq == Once)) return false;
+        for (size_t i = 0; i < n; ++i)
+            if (!(times[i] > 0.0)) return false;
+        const double f = static_cast<double>(freq);
+        switch (comp) {
+            case Simple:
+                for (size_t i = 0; i < n; ++i) out[i] = (1.0 / dfs[i] - 1.0) / times[i];
+                return true;
+            case Continuous:
+                for (size_t i = 0; i < n; ++i) out[i] = -std::log(dfs[i]) / times[i];
+                return true;
+            case Compounded:
+                for (size_t i = 0; i < n; ++i) out[i] = f * (std::exp(-std::log(dfs[i]) / (f * times[i])) - 1.0);
+                return true;
+            case SimpleThenCompounded:
+                for (size_t i = 0; i < n; ++i) {
+                    double simple   = (1.0 / dfs[i] - 1.0) / times[i];
+                    double compound = f * (std::exp(-std::log(dfs[i]) / (f * times[i])) - 1.0);
+                    out[i]          = times[i] <= 1.0 / f ? simple : compound;
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+}  // namespace CurveManager
+
+#endif /* F1716D19_273A_495D_9BF1_5312E1325C7F */
@@ -0,0 +1,38 @@
+#ifndef D3B67A67_8A71_4389_B595_C04FBF9DE864
+#define D3B67A67_8A71_4389_B595_C04FBF9DE864
+
+#include <curvemanager/curvemanager.hpp>
+#include <ql/math/matrix.hpp>
+#include <memory>
+
+namespace CurveManager
+{
+    /*
+     * Bucketed deltas by bump and rebuild. The curve config is parsed and validated once and cloned into one
+     * MarketStore per worker, the clones being built concurrently in trusted input mode; each worker bumps
+     * its share of the tickers and rebootstraps only the affected curves, so every helper type (XCCY,
+     * TENORBASIS, BOND, ...) is supported.
+     */
+    class RiskEngine {
+       public:
+        RiskEngine(const json& data, size_t nThreads = 0);
+
+        /*
+         * Sensitivities of the discount factors at (curves[j], dates[j]) to each ticker: values[i][j] is
+         * (discount with tickers[i] bumped by bump - base discount) / bump.
+         */
+        Matrix discountSensitivities(const std::vector<std::string>& tickers,
+                                     const std::vector<std::string>& curves,
+                                     const std::vector<Date>& dates,
+                                     double bump = 1.0e-4);
+
+        size_t workers() const;
+
+       private:
+        json data_;
+        std::vector<std::unique_ptr<MarketStore>> stores_;
+        std::vector<std::unique_ptr<CurveBuilder>> builders_;
+    };
+}  // namespace CurveManager
+
+#endif /* D3B67A67_8A71_4389_B595_C04FBF9DE864 */
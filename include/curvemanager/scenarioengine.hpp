@@ -0,0 +1,104 @@
+#ifndef D4FD94C0_BA83_446A_9283_E3C2CDD1195D
+#define D4FD94C0_BA83_446A_9283_E3C2CDD1195D
+
+#include <curvemanager/curvesnapshot.hpp>
+#include <ql/compounding.hpp>
+#include <ql/math/matrix.hpp>
+#include <ql/time/frequency.hpp>
+#include <ql/time/period.hpp>
+#include <string>
+#include <vector>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    /*
+     * Zero: the scenario adds a continuously compounded zero rate spread, D(t) exp(-s(t) t), as
+     * InterpolatedPiecewiseZeroSpreadedTermStructure. Forward: it adds an instantaneous forward spread,
+     * D(t) exp(-integral of s from 0 to t). The names are ZERO and FORWARD.
+     */
+    enum class SpreadType
+    {
+        Zero,
+        Forward
+    };
+
+    SpreadType parseSpreadType(const std::string& name);
+
+    /*
+     * Scenarios on top of a compiled curve, without rebootstrapping. A scenario is a spread per pillar (a row
+     * of a scenarios x pillars matrix), interpolated linearly in time between pillars and flat outside them.
+     * Parallel shifts, key rate bumps and twists are such rows (see the shape helpers), so any mix of them
+     * is evaluated on many dates in one pass: the pillar segment and weights of each date are computed once,
+     * and each scenario is then a gather and an exp per date. Results are scenarios x dates matrices.
+     */
+    class ScenarioEngine {
+       public:
+        // pillars are year fractions from the curve reference date, in the curve day counter, increasing
+        ScenarioEngine(CompiledCurve curve, std::vector<Time> pillars, SpreadType type = SpreadType::Zero);
+        ScenarioEngine(CompiledCurve curve, const std::vector<Period>& pillars, SpreadType type = SpreadType::Zero);
+        // compiles the curve of the store, which must be a supported CompiledCurve
+        ScenarioEngine(const MarketStore& marketStore, const std::string& curve, std::vector<Time> pillars, SpreadType type = SpreadType::Zero);
+
+        const CompiledCurve& curve() const {
+            return curve_;
+        };
+        const std::vector<Time>& pillars() const {
+            return pillars_;
+        };
+        SpreadType spreadType() const {
+            return type_;
+        };
+
+        // scenario rows
+        std::vector<double> parallel(double shift) const;
+        // bump at one pillar, fading linearly to zero at its neighbours
+        std::vector<double> keyRate(size_t pillar, double bump) const;
+        // shortShift at the first pillar to longShift at the last, linear in time
+        std::vector<double> twist(double shortShift, double longShift) const;
+
+        /*
+         * spreads is nScenarios x pillars().size(), row major; out is nScenarios x n, row major, and must not
+         * alias spreads.
+         */
+        void discounts(const double* spreads, size_t nScenarios, const Date::serial_type* dates, size_t n, double* out) const;
+        void zeroRates(const double* spreads,
+                       size_t nScenarios,
+                       const Date::serial_type* dates,
+                       size_t n,
+                       const DayCounter& dayCounter,
+                       Compounding comp,
+                       Frequency freq,
+                       double* out) const;
+
+        Matrix discounts(const Matrix& spreads, const std::vector<Date::serial_type>& dates) const;
+        Matrix zeroRates(const Matrix& spreads,
+                         const std::vector<Date::serial_type>& dates,
+                         const DayCounter& dayCounter,
+                         Compounding comp,
+                         Frequency freq) const;
+
+       private:
+        /*
+         * Per date: the log of the spread factor is cumulative[base] + spread[lower] * lowerWeight +
+         * spread[upper] * upperWeight, where cumulative holds the integral of the forward spread up to each
+         * pillar (zero for zero spreads, base is then always 0).
+         */
+        struct Layout {
+            std::vector<uint32_t> base, lower, upper;
+            std::vector<double> lowerWeight, upperWeight, logDiscounts;
+        };
+
+        void checkPillars() const;
+        // times in the curve day counter
+        Layout layout(const Time* times, size_t n) const;
+        void discounts(const double* spreads, size_t nScenarios, const Time* times, size_t n, double* out) const;
+
+        CompiledCurve curve_;
+        std::vector<Time> pillars_;
+        SpreadType type_;
+    };
+}  // namespace CurveManager
+
+#endif /* D4FD94C0_BA83_446A_9283_E3C2CDD1195D */
@@ -0,0 +1,32 @@
+#ifndef EEDC4501_C19B_49EB_8C61_5043C9FB28FD
+#define EEDC4501_C19B_49EB_8C61_5043C9FB28FD
+
+#include <qlp/schemas/schema.hpp>
+#include <nlohmann/json-schema.hpp>
+#include <string>
+
+namespace CurveManager
+{
+    using json = nlohmann::json;
+    using nlohmann::json_schema::json_validator;
+
+    /*
+     * Process wide registry of compiled schemas. Schema<T> builds its JSON schema and validator when it is
+     * constructed, so each type is compiled once, on first use (function local statics are initialized in a
+     * thread safe way). The schemas are shared between threads: only validate, isValid, setDefaultValues
+     * and makeObj may be called on them.
+     */
+    template <typename T>
+    QuantLibParser::Schema<T>& cachedSchema() {
+        static QuantLibParser::Schema<T> schema;
+        return schema;
+    }
+
+    /*
+     * Validator for an ad hoc schema, compiled the first time its key is requested. Later calls with the
+     * same key return the cached validator and ignore the schema argument.
+     */
+    const json_validator& cachedValidator(const std::string& key, const json& schema);
+}  // namespace CurveManager
+
+#endif /* EEDC4501_C19B_49EB_8C61_5043C9FB28FD */
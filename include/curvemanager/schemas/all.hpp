@@ -4,6 +4,7 @@
 #include <curvemanager/schemas/curvebuilderrequest.hpp>
 #include <curvemanager/schemas/discountfactorsrequest.hpp>
 #include <curvemanager/schemas/forwardratesrequest.hpp>
+#include <curvemanager/schemas/jacobianrequest.hpp>
 #include <curvemanager/schemas/updatequoterequest.hpp>
 #include <curvemanager/schemas/zeroratesrequest.hpp>
 
@@ -0,0 +1,19 @@
+#ifndef D5EBEE3E_27D9_4697_A69A_E4917D7309BB
+#define D5EBEE3E_27D9_4697_A69A_E4917D7309BB
+
+#include <qlp/schemas/commonschemas.hpp>
+#include <qlp/schemas/schema.hpp>
+
+namespace QuantLibParser
+{
+    class JacobianRequest;
+
+    template <>
+    void Schema<JacobianRequest>::initSchema();
+
+    template <>
+    void Schema<JacobianRequest>::initDefaultValues();
+
+}  // namespace QuantLibParser
+
+#endif /* D5EBEE3E_27D9_4697_A69A_E4917D7309BB */
@@ -0,0 +1,50 @@
+#ifndef C03A034D_E6F1_4E1B_8978_38EBA36AA9B8
+#define C03A034D_E6F1_4E1B_8978_38EBA36AA9B8
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CurveManager
+{
+    // dense ids of the curves and quotes of a MarketStore, see MarketStore::curveId and MarketStore::quoteId
+    using CurveId = uint32_t;
+    using QuoteId = uint32_t;
+
+    /*
+     * Interns names into dense ids, assigned in insertion order from zero. Names are never removed, so an id
+     * stays valid for the lifetime of the table and can index flat vectors.
+     */
+    class SymbolTable {
+       public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        uint32_t intern(const std::string& name) {
+            auto [it, inserted] = ids_.try_emplace(name, static_cast<uint32_t>(names_.size()));
+            if (inserted) names_.push_back(name);
+            return it->second;
+        };
+
+        // npos if the name was never interned
+        uint32_t find(const std::string& name) const {
+            auto it = ids_.find(name);
+            return it == ids_.end() ? npos : it->second;
+        };
+
+        const std::string& name(uint32_t id) const {
+            return names_.at(id);
+        };
+
+        size_t size() const {
+            return names_.size();
+        };
+
+       private:
+        std::unordered_map<std::string, uint32_t> ids_;
+        std::vector<std::string> names_;
+    };
+}  // namespace CurveManager
+
+#endif /* C03A034D_E6F1_4E1B_8978_38EBA36AA9B8 */
@@ -0,0 +1,256 @@
+#ifndef AA34AAAE_E9C8_4703_B0C0_FC7560E635B7
+#define AA34AAAE_E9C8_4703_B0C0_FC7560E635B7
+
+#include <curvemanager/dateparser.hpp>
+#include <ql/math/interpolations/linearinterpolation.hpp>
+#include <ql/math/interpolations/loginterpolation.hpp>
+#include <ql/math/solvers1d/brent.hpp>
+#include <ql/math/solvers1d/finitedifferencenewtonsafe.hpp>
+#include <ql/termstructures/bootstraperror.hpp>
+#include <ql/termstructures/bootstraphelper.hpp>
+#include <ql/termstructures/yield/bootstraptraits.hpp>
+#include <ql/termstructures/yield/piecewiseyieldcurve.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+namespace CurveManager
+{
+    using namespace QuantLib;
+
+    // node dates and discount factors of a bootstrapped curve, interpolated log-linearly
+    struct CurveSeed {
+        std::vector<Date> dates;
+        std::vector<Real> discounts;
+
+        Real discount(const Date& date) const {
+            if (dates.size() < 2) return discounts.front();
+            size_t j = std::upper_bound(dates.begin(), dates.end(), date) - dates.begin();
+            j        = std::clamp<size_t>(j, 1, dates.size() - 1);  // extrapolated on the first and last segments
+            Real w   = static_cast<Real>(date - dates[j - 1]) / static_cast<Real>(dates[j] - dates[j - 1]);
+            return discounts[j - 1] * std::pow(discounts[j] / discounts[j - 1], w);
+        };
+    };
+
+    /*
+     * Bootstrap of a piecewise curve, following QuantLib's IterativeBootstrap. With warm start on, the root
+     * search of each node starts from a seed, moved as much as the previous node moved from its own, inside a
+     * bracket of +/- bracketWidth on the forward rate of the node's segment (on the node rate for zero and
+     * forward rate traits); the bracket of the traits is only searched when the root is not inside. The seeds
+     * are the last solution of the curve or, for a new discount curve, the nodes of the curve it replaces (see
+     * MarketStore::curveSeed). Without warm start it behaves as IterativeBootstrap.
+     */
+    template <class Curve>
+    class WarmStartBootstrap {
+        typedef typename Curve::traits_type Traits;
+        typedef typename Curve::interpolator_type Interpolator;
+
+       public:
+        explicit WarmStartBootstrap(bool warmStart                          = false,
+                                    Real bracketWidth                       = 1.0e-3,
+                                    boost::shared_ptr<const CurveSeed> seed = nullptr,
+                                    Real accuracy                           = 1.0e-12)
+        : warmStart_(warmStart), bracketWidth_(bracketWidth), seed_(std::move(seed)), accuracy_(accuracy){};
+
+        void setup(Curve* ts) {
+            ts_ = ts;
+            n_  = ts_->instruments_.size();
+            if (n_ == 0) throw std::runtime_error("No bootstrap helpers given");
+            for (Size j = 0; j < n_; ++j) ts_->registerWith(ts_->instruments_[j]);
+            // not initialized yet: the helpers may only become valid later
+        };
+
+        void calculate() const {
+            if (!initialized_ || ts_->moving_) initialize();
+            for (Size j = firstAliveHelper_; j < n_; ++j) {
+                const auto& helper = ts_->instruments_[j];
+                if (!helper->quote()->isValid())
+                    throw std::runtime_error("Invalid quote for the helper with pillar " + formatDDMMYYYY(helper->pillarDate()));
+                helper->setTermStructure(const_cast<Curve*>(ts_));
+            }
+
+            const std::vector<Time>& times = ts_->times_;
+            std::vector<Real>& data        = ts_->data_;
+            bool validData                 = validCurve_;
+
+            // the seeds are taken before the nodes are overwritten; new curves start from them as if they were valid
+            std::vector<Real> seeds = warmStart_ && !coldRetry_ ? nodeSeeds(validData) : std::vector<Real>();
+            if (!validData && !seeds.empty()) {
+                std::copy(seeds.begin() + 1, seeds.end(), data.begin() + 1);
+                ts_->interpolation_ = ts_->interpolator_.interpolate(times.begin(), times.end(), data.begin());
+                ts_->interpolation_.update();
+                validData = true;
+            }
+
+            for (Size iteration = 0;; ++iteration) {
+                previousData_ = data;
+                for (Size i = 1; i <= alive_; ++i) {
+                    if (!seeds.empty() && solveWarm(i, warmTarget(i, seeds, data))) continue;
+
+                    Real min   = Traits::minValueAfter(i, ts_, validData, firstAliveHelper_);
+                    Real max   = Traits::maxValueAfter(i, ts_, validData, firstAliveHelper_);
+                    Real guess = Traits::guess(i, ts_, validData, firstAliveHelper_);
+                    if (guess >= max)
+                        guess = max - (max - min) / 5.0;
+                    else if (guess <= min)
+                        guess = min + (max - min) / 5.0;
+
+                    if (!validData) {
+                        // extended one node at a time, including the node being solved; global interpolations that
+                        // cannot be built on so few nodes use linear until the next iteration
+                        try {
+                            ts_->interpolation_ = ts_->interpolator_.interpolate(times.begin(), times.begin() + i + 1, data.begin());
+                        }
+                        catch (...) {
+                            if (!Interpolator::global) throw;
+                            ts_->interpolation_ = Linear().interpolate(times.begin(), times.begin() + i + 1, data.begin());
+                        }
+                        ts_->interpolation_.update();
+                    }
+
+                    try {
+                        if (validData)
+                            solver_.solve(*errors_[i], accuracy_, guess, min, max);
+                        else
+                            firstSolver_.solve(*errors_[i], accuracy_, guess, min, max);
+                    }
+                    catch (const std::exception& e) {
+                        if (validData && !coldRetry_) {
+                            // the last solution or the seeds may have been a bad guess: start over without them
+                            validCurve_ = initialized_ = false;
+                            coldRetry_                 = true;
+                            try {
+                                calculate();
+                            }
+                            catch (...) {
+                                coldRetry_ = false;
+                                throw;
+                            }
+                            coldRetry_ = false;
+                            return;
+                        }
+                        throw std::runtime_error("Bootstrap failed at pillar " + formatDDMMYYYY(errors_[i]->helper()->pillarDate()) +
+                                                 ", reference date " + formatDDMMYYYY(ts_->dates_[0]) + ": " + e.what());
+                    }
+                }
+
+                if (!loopRequired_) break;
+                Real change = 0.0;
+                for (Size i = 1; i <= alive_; ++i) change = std::max(change, std::fabs(data[i] - previousData_[i]));
+                if (change <= accuracy_) break;
+                if (iteration + 1 >= Traits::maxIterations())
+                    throw std::runtime_error("Bootstrap convergence not reached after " + std::to_string(iteration + 1) + " iterations");
+                validData = true;
+                if (!seeds.empty()) seeds = data;
+            }
+            validCurve_ = true;
+        };
+
+       private:
+        void initialize() const {
+            std::sort(ts_->instruments_.begin(), ts_->instruments_.end(), detail::BootstrapHelperSorter());
+            Date firstDate = Traits::initialDate(ts_);
+            if (ts_->instruments_[n_ - 1]->pillarDate() <= firstDate) throw std::runtime_error("All bootstrap helpers are expired");
+            firstAliveHelper_ = 0;
+            while (ts_->instruments_[firstAliveHelper_]->pillarDate() <= firstDate) ++firstAliveHelper_;
+            alive_ = n_ - firstAliveHelper_;
+            if (alive_ + 1 < Interpolator::requiredPoints) throw std::runtime_error("Not enough alive bootstrap helpers");
+
+            std::vector<Date>& dates = ts_->dates_;
+            std::vector<Time>& times = ts_->times_;
+            dates.resize(alive_ + 1);
+            times.resize(alive_ + 1);
+            errors_.resize(alive_ + 1);
+            dates[0] = firstDate;
+            times[0] = ts_->timeFromReference(dates[0]);
+
+            Date maxDate  = firstDate;
+            loopRequired_ = Interpolator::global;
+            for (Size i = 1, j = firstAliveHelper_; j < n_; ++i, ++j) {
+                const auto& helper = ts_->instruments_[j];
+                dates[i]           = helper->pillarDate();
+                times[i]           = ts_->timeFromReference(dates[i]);
+                if (dates[i - 1] == dates[i]) throw std::runtime_error("More than one bootstrap helper with pillar " + formatDDMMYYYY(dates[i]));
+                Date latestRelevantDate = helper->latestRelevantDate();
+                if (latestRelevantDate <= maxDate)
+                    throw std::runtime_error("The bootstrap helper with pillar " + formatDDMMYYYY(dates[i]) + " does not extend the curve");
+                maxDate = latestRelevantDate;
+                // a pillar before the last relevant date makes the nodes depend on later ones
+                if (dates[i] != latestRelevantDate) loopRequired_ = true;
+                errors_[i] = boost::make_shared<BootstrapError<Curve>>(ts_, helper, i);
+            }
+            ts_->maxDate_ = maxDate;
+
+            if (!validCurve_ || ts_->data_.size() != alive_ + 1) {
+                ts_->data_  = std::vector<Real>(alive_ + 1, Traits::initialValue(ts_));
+                validCurve_ = false;
+            }
+            initialized_ = true;
+        };
+
+        // seeds of the nodes: the last solution of the curve, or the discounts of the replaced curve at the new pillars
+        std::vector<Real> nodeSeeds(bool validData) const {
+            if (validData) return ts_->data_;
+            std::vector<Real> seeds;
+            if constexpr (std::is_same_v<Traits, Discount>) {
+                if (seed_ && !seed_->dates.empty()) {
+                    seeds.resize(alive_ + 1);
+                    Real base = seed_->discount(ts_->dates_[0]);
+                    seeds[0]  = ts_->data_[0];
+                    for (Size i = 1; i <= alive_; ++i) seeds[i] = seed_->discount(ts_->dates_[i]) / base;
+                }
+            }
+            return seeds;
+        };
+
+        // seed of the node moved as the previous node moved from its own seed: in ratio for discounts, in level for rates
+        Real warmTarget(Size i, const std::vector<Real>& seeds, const std::vector<Real>& data) const {
+            if constexpr (std::is_same_v<Traits, Discount>)
+                return seeds[i] * data[i - 1] / seeds[i - 1];
+            else
+                return seeds[i] + data[i - 1] - seeds[i - 1];
+        };
+
+        // tight search around the target; false, leaving the node to the full search, if the root is not inside
+        bool solveWarm(Size i, Real target) const {
+            Real down = target - bracketWidth_;
+            Real up   = target + bracketWidth_;
+            if constexpr (std::is_same_v<Traits, Discount>) {
+                Time dt = ts_->times_[i] - ts_->times_[i - 1];
+                down    = target * std::exp(-bracketWidth_ * dt);
+                up      = target * std::exp(bracketWidth_ * dt);
+            }
+            Real lower = std::min(down, up);
+            Real upper = std::max(down, up);
+            if (!(lower < upper)) return false;
+            try {
+                solver_.solve(*errors_[i], accuracy_, target, lower, upper);
+                return true;
+            }
+            catch (const std::exception&) {
+                return false;
+            }
+        };
+
+        bool warmStart_;
+        Real bracketWidth_;
+        boost::shared_ptr<const CurveSeed> seed_;
+        Real accuracy_;
+
+        Curve* ts_ = nullptr;
+        Size n_    = 0;
+        mutable Size firstAliveHelper_ = 0;
+        mutable Size alive_            = 0;
+        mutable bool initialized_      = false;
+        mutable bool validCurve_       = false;
+        mutable bool loopRequired_     = false;
+        mutable bool coldRetry_        = false;
+        mutable std::vector<Real> previousData_;
+        mutable std::vector<boost::shared_ptr<BootstrapError<Curve>>> errors_;
+        mutable Brent solver_;
+        mutable FiniteDifferenceNewtonSafe firstSolver_;
+    };
+}  // namespace CurveManager
+
+#endif /* AA34AAAE_E9C8_4703_B0C0_FC7560E635B7 */
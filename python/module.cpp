@@ -5,7 +5,16 @@
  */
 
 #include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/encoding.hpp>
+#include <curvemanager/historyengine.hpp>
+#include <curvemanager/quotequeue.hpp>
+#include <curvemanager/riskengine.hpp>
+#include <curvemanager/scenarioengine.hpp>
 #include <curvemanager/schemas/all.hpp>
+#include <qlp/parser.hpp>
+#include <pybind11/chrono.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11_json/pybind11_json.hpp>
@@ -28,24 +37,369 @@ using namespace std;
         .def("addRequired", &Schema<name>::addRequired)               \
         .def("removeRequired", &Schema<name>::removeRequired)
 
+namespace
+{
+    // numpy's datetime64 counts from 1970-01-01, which is serial number 25569 in QuantLib
+    constexpr Date::serial_type unixEpochSerial = 25569;
+
+    using SerialArray = py::array_t<Date::serial_type, py::array::c_style | py::array::forcecast>;
+    using ValueArray  = py::array_t<double, py::array::c_style>;
+
+    /*
+     * Dates as a contiguous array of serial numbers. Integer arrays are taken as serial numbers and are not
+     * copied when their dtype already matches Date::serial_type; datetime64 arrays (any unit) are truncated
+     * to days and shifted to serial numbers.
+     */
+    SerialArray toSerials(const py::array& dates) {
+        const char kind = dates.dtype().kind();
+        if (kind == 'M') {
+            py::array days          = dates.attr("astype")("datetime64[D]").attr("astype")("int64");
+            SerialArray serials     = SerialArray::ensure(days);
+            Date::serial_type* data = serials.mutable_data();
+            for (py::ssize_t i = 0; i < serials.size(); ++i) data[i] += unixEpochSerial;
+            return serials;
+        }
+        if (kind != 'i' && kind != 'u') throw std::runtime_error("Dates must be datetime64 or integer serial numbers");
+        return SerialArray::ensure(dates);
+    }
+
+    ValueArray emptyLike(const py::array& dates) {
+        return ValueArray(std::vector<py::ssize_t>(dates.shape(), dates.shape() + dates.ndim()));
+    }
+
+    /*
+     * Readers of a live (not versioned) store trigger the lazy bootstrap of the curve, which must not run
+     * concurrently, so it is done before the GIL is released.
+     */
+    void prepareCurve(const MarketStore& store, CurveId curve) {
+        if (!store.isVersioned()) store.getCurve(curve)->discount(0.0, true);
+    }
+
+    // scenarios x pillars spreads, as a contiguous matrix
+    py::array_t<double, py::array::c_style> toSpreads(const ScenarioEngine& engine, const py::array& spreads) {
+        auto matrix = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(spreads);
+        if (!matrix || matrix.ndim() != 2 || static_cast<size_t>(matrix.shape(1)) != engine.pillars().size())
+            throw std::runtime_error("Scenario spreads must be a scenarios x pillars matrix");
+        return matrix;
+    }
+}  // namespace
+
 PYBIND11_MODULE(CurveManager, m) {
     m.doc() = "CurveManager for python";  // optional module docstring
 
     py::class_<MarketStore>(m, "MarketStore")
         .def(py::init<>())
         .def("allCurves", &MarketStore::allCurves)
+        .def("curveId", &MarketStore::curveId)
+        .def("quoteId", &MarketStore::quoteId)
         .def("bootstrapResults", &MarketStore::bootstrapResults)
-        .def("discountRequest", &MarketStore::discountRequest)
-        .def("zeroRateRequest", &MarketStore::zeroRateRequest)
-        .def("forwardRateRequest", &MarketStore::forwardRateRequest);
+        .def("publishSnapshot", py::overload_cast<>(&MarketStore::publishSnapshot))
+        .def("setVersioned", &MarketStore::setVersioned)
+        .def("isVersioned", &MarketStore::isVersioned)
+        .def("setTrustedInput", &MarketStore::setTrustedInput)
+        .def("isTrustedInput", &MarketStore::isTrustedInput)
+        .def("discountRequest", py::overload_cast<const json&>(&MarketStore::discountRequest, py::const_))
+        .def("zeroRateRequest", py::overload_cast<const json&>(&MarketStore::zeroRateRequest, py::const_))
+        .def(
+            "discountRequestEncoded",
+            [](const MarketStore& store, const py::bytes& request, const std::string& encoding, const std::string& responseEncoding) {
+                std::string_view data = request;
+                ResponseEncoder encoder(parseEncoding(responseEncoding));
+                const auto& out = store.discountRequest(reinterpret_cast<const uint8_t*>(data.data()), data.size(), parseEncoding(encoding), encoder);
+                return py::bytes(reinterpret_cast<const char*>(out.data()), out.size());
+            },
+            py::arg("request"),
+            py::arg("encoding")         = "JSON",
+            py::arg("responseEncoding") = "JSON")
+        .def(
+            "zeroRateRequestEncoded",
+            [](const MarketStore& store, const py::bytes& request, const std::string& encoding, const std::string& responseEncoding) {
+                std::string_view data = request;
+                ResponseEncoder encoder(parseEncoding(responseEncoding));
+                const auto& out = store.zeroRateRequest(reinterpret_cast<const uint8_t*>(data.data()), data.size(), parseEncoding(encoding), encoder);
+                return py::bytes(reinterpret_cast<const char*>(out.data()), out.size());
+            },
+            py::arg("request"),
+            py::arg("encoding")         = "JSON",
+            py::arg("responseEncoding") = "JSON")
+        .def("forwardRateRequest", py::overload_cast<const json&>(&MarketStore::forwardRateRequest, py::const_))
+        .def(
+            "forwardRateRequestEncoded",
+            [](const MarketStore& store, const py::bytes& request, const std::string& encoding, const std::string& responseEncoding) {
+                std::string_view data = request;
+                ResponseEncoder encoder(parseEncoding(responseEncoding));
+                const auto& out =
+                    store.forwardRateRequest(reinterpret_cast<const uint8_t*>(data.data()), data.size(), parseEncoding(encoding), encoder);
+                return py::bytes(reinterpret_cast<const char*>(out.data()), out.size());
+            },
+            py::arg("request"),
+            py::arg("encoding")         = "JSON",
+            py::arg("responseEncoding") = "JSON")
+        .def("jacobianRequest", &MarketStore::jacobianRequest)
+        .def("loadFixings", &MarketStore::loadFixings, py::arg("path"), py::call_guard<py::gil_scoped_release>())
+        .def(
+            "addFixings",
+            [](MarketStore& store, const std::string& name, const py::array& dates, const py::array& values) {
+                SerialArray serials = toSerials(dates);
+                auto fixings        = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(values);
+                if (!fixings || fixings.size() != serials.size()) throw std::runtime_error("Dates and values must have the same size");
+                std::vector<Date> qlDates;
+                qlDates.reserve(serials.size());
+                for (py::ssize_t i = 0; i < serials.size(); ++i) qlDates.push_back(Date(serials.data()[i]));
+                std::vector<double> qlValues(fixings.data(), fixings.data() + fixings.size());
+                py::gil_scoped_release release;
+                return store.addFixings(name, qlDates, qlValues);
+            },
+            py::arg("name"),
+            py::arg("dates"),
+            py::arg("values"))
+        .def(
+            "discounts",
+            [](const MarketStore& store, const std::string& curve, const py::array& dates) {
+                CurveId id                  = store.curveId(curve);
+                SerialArray serials         = toSerials(dates);
+                ValueArray values           = emptyLike(serials);
+                const Date::serial_type* in = serials.data();
+                double* out                 = values.mutable_data();
+                size_t n                    = serials.size();
+                prepareCurve(store, id);
+                {
+                    py::gil_scoped_release release;
+                    store.discounts(id, in, n, out);
+                }
+                return values;
+            },
+            py::arg("curve"),
+            py::arg("dates"))
+        .def(
+            "zeroRates",
+            [](const MarketStore& store,
+               const std::string& curve,
+               const py::array& dates,
+               const std::string& dayCounter,
+               const std::string& compounding,
+               const std::string& frequency) {
+                CurveId id                  = store.curveId(curve);
+                DayCounter qlDayCounter     = parse<DayCounter>(dayCounter);
+                Compounding comp            = parse<Compounding>(compounding);
+                Frequency freq              = parse<Frequency>(frequency);
+                SerialArray serials         = toSerials(dates);
+                ValueArray values           = emptyLike(serials);
+                const Date::serial_type* in = serials.data();
+                double* out                 = values.mutable_data();
+                size_t n                    = serials.size();
+                prepareCurve(store, id);
+                {
+                    py::gil_scoped_release release;
+                    store.zeroRates(id, in, n, qlDayCounter, comp, freq, out);
+                }
+                return values;
+            },
+            py::arg("curve"),
+            py::arg("dates"),
+            py::arg("dayCounter")  = "ACT360",
+            py::arg("compounding") = "SIMPLE",
+            py::arg("frequency")   = "ANNUAL")
+        .def(
+            "forwardRates",
+            [](const MarketStore& store,
+               const std::string& curve,
+               const py::array& startDates,
+               const py::array& endDates,
+               const std::string& dayCounter,
+               const std::string& compounding,
+               const std::string& frequency) {
+                CurveId id              = store.curveId(curve);
+                DayCounter qlDayCounter = parse<DayCounter>(dayCounter);
+                Compounding comp        = parse<Compounding>(compounding);
+                Frequency freq          = parse<Frequency>(frequency);
+                SerialArray starts      = toSerials(startDates);
+                SerialArray ends        = toSerials(endDates);
+                if (starts.size() != ends.size()) throw std::runtime_error("Start and end dates must have the same size");
+                ValueArray values          = emptyLike(starts);
+                const Date::serial_type* s = starts.data();
+                const Date::serial_type* e = ends.data();
+                double* out                = values.mutable_data();
+                size_t n                   = starts.size();
+                prepareCurve(store, id);
+                {
+                    py::gil_scoped_release release;
+                    store.forwardRates(id, s, e, n, qlDayCounter, comp, freq, out);
+                }
+                return values;
+            },
+            py::arg("curve"),
+            py::arg("startDates"),
+            py::arg("endDates"),
+            py::arg("dayCounter")  = "ACT360",
+            py::arg("compounding") = "SIMPLE",
+            py::arg("frequency")   = "ANNUAL")
+        .def("metrics", &MarketStore::metrics)
+        .def("prometheusMetrics", &MarketStore::prometheusMetrics);
+
+    // builds and quote updates release the GIL, so that other Python threads keep running (and may drive
+    // other store/builder pairs) during the bootstrap
+    using ReleaseGIL = py::call_guard<py::gil_scoped_release>;
+    m.def("hasThreadLocalSettings", &hasThreadLocalSettings);
+    m.def("readCurveConfig", py::overload_cast<const std::string&>(&readCurveConfig), py::arg("path"), ReleaseGIL());
 
     py::class_<CurveBuilder>(m, "CurveBuilder")
-        .def(py::init<json, MarketStore&>(), py::arg("data"), py::arg("marketStore"))
-        .def("build", &CurveBuilder::build)
-        .def("updateQuotes", &CurveBuilder::updateQuotes, py::arg("prices"));
+        .def(py::init<json, MarketStore&, size_t>(), py::arg("data"), py::arg("marketStore"), py::arg("nThreads") = 1, ReleaseGIL())
+        .def("build", &CurveBuilder::build, ReleaseGIL())
+        .def("buildParallel", &CurveBuilder::buildParallel, py::arg("nThreads") = 0, ReleaseGIL())
+        .def("buildWaves", &CurveBuilder::buildWaves)
+        .def("buildTimes", &CurveBuilder::buildTimes)
+        .def("configLoadTimes",
+             [](const CurveBuilder& builder) {
+                 const ConfigLoadTimes& times = builder.configLoadTimes();
+                 return json{{"VALIDATE", times.validateMs}, {"PREPROCESS", times.preprocessMs}};
+             })
+        .def("referenceDate", [](const CurveBuilder& builder) { return cachedFormatDate(builder.referenceDate()); })
+        .def("computeJacobian", &CurveBuilder::computeJacobian, py::arg("name"), ReleaseGIL())
+        .def("setJacobianMode", &CurveBuilder::setJacobianMode)
+        .def("setWarmStart", &CurveBuilder::setWarmStart, py::arg("enabled"), py::arg("bracketWidth") = 1.0e-3)
+        .def("updateQuotes", py::overload_cast<const json&>(&CurveBuilder::updateQuotes), py::arg("prices"), ReleaseGIL())
+        .def("updateQuotes",
+             py::overload_cast<const std::vector<QuoteId>&, const std::vector<double>&>(&CurveBuilder::updateQuotes),
+             py::arg("quotes"),
+             py::arg("values"),
+             ReleaseGIL());
+
+    py::class_<MarketHistory>(m, "MarketHistory")
+        .def(py::init<>())
+        .def_static("fromCSV", &MarketHistory::fromCSV, py::arg("quotesPath"), py::arg("fixingsPath") = "")
+        .def_static("fromBinary", &MarketHistory::fromBinary, py::arg("path"))
+        .def("saveBinary", &MarketHistory::saveBinary, py::arg("path"))
+        .def("dates", [](const MarketHistory& history) {
+            std::vector<std::string> dates;
+            for (const auto& date : history.dates()) dates.push_back(cachedFormatDate(date));
+            return dates;
+        });
+
+    py::class_<HistoryEngine>(m, "HistoryEngine")
+        .def(py::init<json, const MarketHistory&, size_t>(), py::arg("config"), py::arg("history"), py::arg("nThreads") = 0, py::keep_alive<1, 3>())
+        .def("run", py::overload_cast<const std::string&>(&HistoryEngine::run), py::arg("path"), ReleaseGIL())
+        .def("errors", [](const HistoryEngine& engine) {
+            json errors;
+            for (const auto& [date, error] : engine.errors()) errors[cachedFormatDate(date)] = error;
+            return errors;
+        });
+
+    py::class_<QuoteQueue>(m, "QuoteQueue")
+        .def(py::init<CurveBuilder&, MarketStore&, size_t, std::chrono::milliseconds>(),
+             py::arg("builder"),
+             py::arg("marketStore"),
+             py::arg("maxBatch") = 256,
+             py::arg("interval") = std::chrono::milliseconds(10),
+             py::keep_alive<1, 2>(),
+             py::keep_alive<1, 3>())
+        .def("push", py::overload_cast<const std::string&, double>(&QuoteQueue::push), py::arg("ticker"), py::arg("value"))
+        .def("push", py::overload_cast<QuoteId, double>(&QuoteQueue::push), py::arg("quote"), py::arg("value"))
+        .def("flush", &QuoteQueue::flush)
+        .def("start", &QuoteQueue::start)
+        .def("stop", &QuoteQueue::stop)
+        .def("isRunning", &QuoteQueue::isRunning)
+        .def("replay", &QuoteQueue::replay, py::arg("path"))
+        .def("stats", [](const QuoteQueue& queue) {
+            QuoteQueueStats stats = queue.stats();
+            json results;
+            results["DEPTH"]     = stats.depth;
+            results["RECEIVED"]  = stats.received;
+            results["COALESCED"] = stats.coalesced;
+            results["DROPPED"]   = stats.dropped;
+            results["APPLIED"]   = stats.applied;
+            results["BATCHES"]   = stats.batches;
+            return results;
+        });
+
+    py::class_<RiskEngine>(m, "RiskEngine")
+        .def(py::init<json, size_t>(), py::arg("data"), py::arg("nThreads") = 0)
+        .def("workers", &RiskEngine::workers)
+        .def(
+            "discountSensitivities",
+            [](RiskEngine& engine,
+               const std::vector<std::string>& tickers,
+               const std::vector<std::string>& curves,
+               const std::vector<std::string>& dates,
+               double bump) {
+                std::vector<Date> qlDates;
+                for (const auto& date : dates) qlDates.push_back(cachedParseDate(date));
+                Matrix values = engine.discountSensitivities(tickers, curves, qlDates, bump);
+                std::vector<std::vector<double>> rows;
+                for (Size i = 0; i < values.rows(); ++i) rows.emplace_back(values.row_begin(i), values.row_end(i));
+                return rows;
+            },
+            py::arg("tickers"),
+            py::arg("curves"),
+            py::arg("dates"),
+            py::arg("bump") = 1.0e-4);
+
+    py::class_<ScenarioEngine>(m, "ScenarioEngine")
+        .def(py::init([](const MarketStore& store, const std::string& curve, std::vector<Time> pillars, const std::string& spreadType) {
+                 prepareCurve(store, store.curveId(curve));
+                 return ScenarioEngine(store, curve, std::move(pillars), parseSpreadType(spreadType));
+             }),
+             py::arg("store"),
+             py::arg("curve"),
+             py::arg("pillars"),
+             py::arg("spreadType") = "ZERO")
+        .def("pillars", &ScenarioEngine::pillars)
+        .def("parallel", &ScenarioEngine::parallel, py::arg("shift"))
+        .def("keyRate", &ScenarioEngine::keyRate, py::arg("pillar"), py::arg("bump"))
+        .def("twist", &ScenarioEngine::twist, py::arg("shortShift"), py::arg("longShift"))
+        .def(
+            "discounts",
+            [](const ScenarioEngine& engine, const py::array& spreads, const py::array& dates) {
+                auto matrix                = toSpreads(engine, spreads);
+                SerialArray serials        = toSerials(dates);
+                ValueArray values          = ValueArray(std::vector<py::ssize_t>{matrix.shape(0), serials.size()});
+                const double* in           = matrix.data();
+                const Date::serial_type* d = serials.data();
+                double* out                = values.mutable_data();
+                size_t nScenarios          = matrix.shape(0);
+                size_t n                   = serials.size();
+                {
+                    py::gil_scoped_release release;
+                    engine.discounts(in, nScenarios, d, n, out);
+                }
+                return values;
+            },
+            py::arg("spreads"),
+            py::arg("dates"))
+        .def(
+            "zeroRates",
+            [](const ScenarioEngine& engine,
+               const py::array& spreads,
+               const py::array& dates,
+               const std::string& dayCounter,
+               const std::string& compounding,
+               const std::string& frequency) {
+                DayCounter qlDayCounter    = parse<DayCounter>(dayCounter);
+                Compounding comp           = parse<Compounding>(compounding);
+                Frequency freq             = parse<Frequency>(frequency);
+                auto matrix                = toSpreads(engine, spreads);
+                SerialArray serials        = toSerials(dates);
+                ValueArray values          = ValueArray(std::vector<py::ssize_t>{matrix.shape(0), serials.size()});
+                const double* in           = matrix.data();
+                const Date::serial_type* d = serials.data();
+                double* out                = values.mutable_data();
+                size_t nScenarios          = matrix.shape(0);
+                size_t n                   = serials.size();
+                {
+                    py::gil_scoped_release release;
+                    engine.zeroRates(in, nScenarios, d, n, qlDayCounter, comp, freq, out);
+                }
+                return values;
+            },
+            py::arg("spreads"),
+            py::arg("dates"),
+            py::arg("dayCounter")  = "ACT360",
+            py::arg("compounding") = "SIMPLE",
+            py::arg("frequency")   = "ANNUAL");
 
     // requests
     SchemaWithoutMaker(DiscountFactorsRequest);
     SchemaWithoutMaker(ForwardRatesRequest);
     SchemaWithoutMaker(ZeroRatesRequests);
+    SchemaWithoutMaker(JacobianRequest);
 }
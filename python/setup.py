@@ -47,7 +47,9 @@ ext_modules = [
                       include_dirs=include_dirs,
                       library_dirs=library_dirs,
                       libraries=libraries,
-                      define_macros=[('VERSION_INFO', __version__)],
+                      # CURVEMANAGER_METRICS should match the option used to build the library
+                      define_macros=[('VERSION_INFO', __version__),
+                                     ('CURVEMANAGER_METRICS', None)],
                       extra_compile_args=extra_compile_args,
                       language="c++20"
                       ),
@@ -0,0 +1,236 @@
+#include <curvemanager/dateparser.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using json  = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port         = 5555;
+        std::string unixPath;
+        std::string curve;
+        std::string refDate;
+        std::string type   = "DISCOUNT";
+        size_t connections = 4;
+        size_t requests    = 10000;  // per connection
+        size_t pipeline    = 16;     // lines in flight per connection
+        size_t batch       = 1;      // requests per line
+        size_t dates       = 10;     // dates per request
+    };
+
+    void usage() {
+        std::cerr << "usage: curvemanager_loadgen --curve NAME --refdate DDMMYYYY [--host HOST] [--port PORT] [--unix PATH]\n"
+                     "                            [--type DISCOUNT|ZERORATE|FORWARDRATE] [--connections C] [--requests N]\n"
+                     "                            [--pipeline P] [--batch B] [--dates D]\n"
+                     "  Each of the C connections sends N requests of D dates, B per line, keeping P lines in flight, and\n"
+                     "  reports the throughput and the latency percentiles of the answers.\n";
+    }
+
+    int connect(const Options& options) {
+        int fd;
+        if (!options.unixPath.empty()) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (options.unixPath.size() >= sizeof(address.sun_path)) throw std::runtime_error("Invalid Unix socket path: " + options.unixPath);
+            std::memcpy(address.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+            fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+                throw std::runtime_error("Could not connect to " + options.unixPath + ": " + std::strerror(errno));
+            return fd;
+        }
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port   = htons(static_cast<uint16_t>(options.port));
+        if (::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) throw std::runtime_error("Invalid IPv4 address: " + options.host);
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            throw std::runtime_error("Could not connect to " + options.host + ":" + std::to_string(options.port) + ": " + std::strerror(errno));
+        int yes = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        return fd;
+    }
+
+    void sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    // one line of requests, the same body every time: the server does the same work for each
+    std::string requestLine(const Options& options, size_t firstId) {
+        QuantLib::Date refDate;
+        if (!CurveManager::parseDDMMYYYY(options.refDate.data(), options.refDate.size(), refDate))
+            throw std::runtime_error("Invalid reference date (expected DDMMYYYY): " + options.refDate);
+        json body = {{"REFDATE", options.refDate}, {"CURVE", options.curve}, {"DATES", json::array()}};
+        for (size_t i = 1; i <= options.dates; ++i) {
+            std::string date = CurveManager::formatDDMMYYYY(refDate + static_cast<int>(30 * i));
+            // forward rates take [start, end] pairs, here consecutive periods
+            if (options.type == "FORWARDRATE")
+                body["DATES"].push_back(json::array({CurveManager::formatDDMMYYYY(refDate + static_cast<int>(30 * (i - 1))), date}));
+            else
+                body["DATES"].push_back(date);
+        }
+
+        json requests = json::array();
+        for (size_t i = 0; i < options.batch; ++i) requests.push_back({{"ID", firstId + i}, {"TYPE", options.type}, {"BODY", body}});
+        return (options.batch == 1 ? requests[0] : requests).dump() + "\n";
+    }
+
+    struct Result {
+        std::vector<double> latencies;  // microseconds, one per line
+        size_t errors = 0;
+    };
+
+    // keeps pipeline lines in flight: a new line is sent for every answer read
+    void runConnection(const Options& options, Result& result) {
+        int fd            = connect(options);
+        size_t lines      = (options.requests + options.batch - 1) / options.batch;
+        std::string line  = requestLine(options, 0);
+        std::vector<Clock::time_point> sentAt(lines);
+        result.latencies.reserve(lines);
+
+        size_t sent = 0, received = 0;
+        std::string window;
+        for (; sent < std::min(lines, options.pipeline); ++sent) window += line;
+        auto start = Clock::now();
+        for (size_t i = 0; i < sent; ++i) sentAt[i] = start;
+        sendAll(fd, window);
+
+        std::string input;
+        char buffer[1 << 16];
+        while (received < lines) {
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error("Connection closed by the server");
+            auto now = Clock::now();
+            input.append(buffer, static_cast<size_t>(n));
+
+            size_t begin = 0, answers = 0;
+            for (size_t end; (end = input.find('\n', begin)) != std::string::npos; begin = end + 1, ++answers) {
+                result.latencies.push_back(std::chrono::duration<double, std::micro>(now - sentAt[received + answers]).count());
+                if (input.find("\"ERROR\"", begin) < end) ++result.errors;
+            }
+            input.erase(0, begin);
+            received += answers;
+
+            window.clear();
+            size_t next = std::min(lines, received + options.pipeline);
+            for (; sent < next; ++sent) {
+                window += line;
+                sentAt[sent] = now;
+            }
+            if (!window.empty()) sendAll(fd, window);
+        }
+        ::close(fd);
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t i = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[i];
+    }
+}  // namespace
+
+/*
+ * Load generator for curvemanager_server: closed loop clients, one thread per connection, each keeping a
+ * fixed number of pipelined lines in flight. Latency is measured per line, from its send to its answer.
+ */
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host")
+            options.host = value;
+        else if (arg == "--port")
+            options.port = std::stoi(value);
+        else if (arg == "--unix")
+            options.unixPath = value;
+        else if (arg == "--curve")
+            options.curve = value;
+        else if (arg == "--refdate")
+            options.refDate = value;
+        else if (arg == "--type")
+            options.type = value;
+        else if (arg == "--connections")
+            options.connections = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--requests")
+            options.requests = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--pipeline")
+            options.pipeline = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--batch")
+            options.batch = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--dates")
+            options.dates = std::max<size_t>(1, std::stoul(value));
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.curve.empty() || options.refDate.empty()) {
+        usage();
+        return 1;
+    }
+
+    std::vector<Result> results(options.connections);
+    std::vector<std::thread> clients;
+    std::atomic<bool> failed{false};
+    auto start = Clock::now();
+    for (size_t i = 0; i < options.connections; ++i) {
+        clients.emplace_back([&, i]() {
+            try {
+                runConnection(options, results[i]);
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                failed = true;
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (failed) return 1;
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    size_t requests = latencies.size() * options.batch;
+
+    std::cout << "connections " << options.connections << ", pipeline " << options.pipeline << ", batch " << options.batch << ", dates "
+              << options.dates << "\n"
+              << "requests    " << requests << " in " << seconds << " s (" << static_cast<double>(requests) / seconds << " requests/s), "
+              << errors << " lines with errors\n"
+              << "latency us  p50 " << percentile(latencies, 0.50) << ", p90 " << percentile(latencies, 0.90) << ", p99 "
+              << percentile(latencies, 0.99) << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << " (per line)\n";
+    return errors > 0 ? 2 : 0;
+}
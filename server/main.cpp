@@ -0,0 +1,99 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include "server.hpp"
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace CurveManager;
+
+namespace
+{
+    CurveServer* activeServer = nullptr;
+
+    void onSignal(int) {
+        if (activeServer) activeServer->stop();
+    }
+
+    void usage() {
+        std::cerr << "usage: curvemanager_server CONFIG [--host HOST] [--port PORT] [--unix PATH] [--threads N] [--fixings PATH]\n"
+                     "  Builds the curves of CONFIG and serves them on HOST:PORT (127.0.0.1:5555 by default) and/or on the\n"
+                     "  Unix socket PATH. N is the number of query threads, also used for the build (0, the default, means\n"
+                     "  one per core). FIXINGS is a columnar fixings file (see readFixings).\n";
+    }
+}  // namespace
+
+/*
+ * Stand alone curve query server: builds a config once and serves it with CurveServer until SIGINT or
+ * SIGTERM. The store is versioned, so quote updates publish a new epoch for the queries.
+ */
+int main(int argc, char** argv) {
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0) {
+        usage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    std::string config = argv[1];
+    std::string host   = "127.0.0.1";
+    std::string unixPath;
+    std::string fixings;
+    int port       = -1;
+    size_t threads = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host")
+            host = value;
+        else if (arg == "--port")
+            port = std::stoi(value);
+        else if (arg == "--unix")
+            unixPath = value;
+        else if (arg == "--threads")
+            threads = std::stoul(value);
+        else if (arg == "--fixings")
+            fixings = value;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    try {
+        MarketStore store;
+        store.setVersioned(true);
+        CurveBuilder builder(readCurveConfig(config), store, threads);
+        if (!fixings.empty()) std::cout << "Loaded " << store.loadFixings(fixings) << " fixings\n";
+        builder.buildParallel(threads);
+        std::cout << "Built " << store.allCurves().size() << " curves for " << formatDDMMYYYY(builder.referenceDate()) << "\n";
+
+        CurveServer server(builder, store, threads);
+        if (!unixPath.empty()) {
+            server.listenUnix(unixPath);
+            std::cout << "Listening on " << unixPath << "\n";
+        }
+        if (unixPath.empty() || port >= 0) {
+            uint16_t bound = server.listenTCP(host, static_cast<uint16_t>(port >= 0 ? port : 5555));
+            std::cout << "Listening on " << host << ":" << bound << "\n";
+        }
+        std::cout.flush();
+
+        activeServer = &server;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        server.run();
+        activeServer = nullptr;
+
+        ServerStats stats = server.stats();
+        std::cout << "Served " << stats.requests << " requests (" << stats.errors << " errors) on " << stats.connections << " connections\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
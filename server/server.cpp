@@ -0,0 +1,384 @@
+#include "server.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace CurveManager
+{
+    namespace
+    {
+        // epoll tags: connections use their id, below listenerTag
+        const uint64_t listenerTag = uint64_t(1) << 63;
+        const uint64_t wakeupTag   = ~uint64_t(0);
+
+        // a connection whose unfinished line grows beyond this is dropped
+        const size_t maxLineBytes = 64 << 20;
+
+        // while out of descriptors the listeners are disarmed until a connection closes, or for this long
+        const int acceptRetryMs = 100;
+
+        [[noreturn]] void fail(const std::string& what, int fd = -1) {
+            std::string error = std::strerror(errno);
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error(what + ": " + error);
+        }
+
+        void addToEpoll(int epoll, int fd, uint64_t tag, uint32_t events) {
+            epoll_event event{};
+            event.events   = events;
+            event.data.u64 = tag;
+            if (::epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) fail("epoll_ctl failed");
+        }
+
+        std::string dump(const json& answer) {
+            // error messages may quote invalid UTF-8 from the request
+            return answer.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+    }  // namespace
+
+    CurveServer::CurveServer(CurveBuilder& builder, MarketStore& marketStore, size_t nThreads)
+    : builder_(builder), marketStore_(marketStore) {
+        epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_ < 0) fail("epoll_create1 failed");
+        wakeup_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeup_ < 0) fail("eventfd failed", epoll_);
+        addToEpoll(epoll_, wakeup_, wakeupTag, EPOLLIN);
+        // queries read the published epoch, so that they never wait for a quote update
+        marketStore_.setVersioned(true);
+        if (!marketStore_.snapshot()) marketStore_.publishSnapshot();
+        pool_ = std::make_unique<utils::ThreadPool>(nThreads);
+    };
+
+    CurveServer::~CurveServer() {
+        // the running tasks still post their answers through the eventfd
+        pool_.reset();
+        for (const auto& [id, connection] : connections_) ::close(connection.fd);
+        for (int listener : listeners_) ::close(listener);
+        for (const auto& path : unixPaths_) ::unlink(path.c_str());
+        ::close(wakeup_);
+        ::close(epoll_);
+    };
+
+    uint16_t CurveServer::listenTCP(const std::string& host, uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port   = htons(port);
+        if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) throw std::runtime_error("Invalid IPv4 address: " + host);
+
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) fail("socket failed");
+        int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) fail("Could not bind " + host + ":" + std::to_string(port), fd);
+        if (::listen(fd, SOMAXCONN) != 0) fail("listen failed", fd);
+
+        socklen_t length = sizeof(address);
+        if (::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) fail("getsockname failed", fd);
+        addListener(fd);
+        return ntohs(address.sin_port);
+    }
+
+    void CurveServer::listenUnix(const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Invalid Unix socket path: " + path);
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) fail("socket failed");
+        // a socket file left by a previous run would make bind fail
+        ::unlink(path.c_str());
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) fail("Could not bind " + path, fd);
+        if (::listen(fd, SOMAXCONN) != 0) fail("listen failed", fd);
+        unixPaths_.push_back(path);
+        addListener(fd);
+    }
+
+    void CurveServer::addListener(int fd) {
+        try {
+            addToEpoll(epoll_, fd, listenerTag | listeners_.size(), EPOLLIN);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+        listeners_.push_back(fd);
+    }
+
+    void CurveServer::run() {
+        if (listeners_.empty()) throw std::runtime_error("The server is not listening on any socket");
+        std::vector<epoll_event> events(256);
+        while (!stopping_.load()) {
+            int n = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()), acceptPaused_ ? acceptRetryMs : -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail("epoll_wait failed");
+            }
+            if (n == 0) pauseAccept(false);
+            for (int i = 0; i < n; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == wakeupTag) {
+                    uint64_t count;
+                    while (::read(wakeup_, &count, sizeof(count)) > 0) {
+                    }
+                    complete();
+                }
+                else if (tag & listenerTag) {
+                    accept(listeners_[tag & ~listenerTag]);
+                }
+                else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    // both directions are gone (a half closed peer only reads EOF): nobody is left to answer
+                    close(tag);
+                }
+                else {
+                    if (events[i].events & EPOLLIN) read(tag);
+                    if (events[i].events & EPOLLOUT) write(tag);
+                }
+            }
+        }
+    }
+
+    void CurveServer::stop() {
+        // only async signal safe calls: an atomic store and a write
+        stopping_.store(true);
+        uint64_t one                     = 1;
+        [[maybe_unused]] ssize_t written = ::write(wakeup_, &one, sizeof(one));
+    }
+
+    ServerStats CurveServer::stats() const {
+        ServerStats stats;
+        stats.connections = accepted_.load();
+        stats.requests    = requests_.load();
+        stats.errors      = errors_.load();
+        return stats;
+    }
+
+    void CurveServer::accept(int listener) {
+        for (;;) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                // the listeners are level triggered: left armed without descriptors they would wake the loop forever
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) pauseAccept(true);
+                // EAGAIN once the backlog is empty
+                return;
+            }
+            // answers are written in one send per task; without it small answers would wait for delayed ACKs
+            int yes = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+            uint64_t id = nextConnection_++;
+            epoll_event event{};
+            event.events   = EPOLLIN;
+            event.data.u64 = id;
+            if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) != 0) {
+                ::close(fd);
+                continue;
+            }
+            Connection& client = connections_[id];
+            client.fd          = fd;
+            client.events      = event.events;
+            accepted_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void CurveServer::read(uint64_t id) {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) return;
+        Connection& client = it->second;
+
+        char buffer[1 << 16];
+        // start of the unfinished line: a client that never sends a line break is dropped before it fills memory
+        size_t lineStart = client.input.rfind('\n');
+        lineStart        = lineStart == std::string::npos ? 0 : lineStart + 1;
+        for (;;) {
+            ssize_t n = ::read(client.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                const char* last = static_cast<const char*>(::memrchr(buffer, '\n', static_cast<size_t>(n)));
+                if (last) lineStart = client.input.size() + static_cast<size_t>(last - buffer) + 1;
+                client.input.append(buffer, static_cast<size_t>(n));
+                if (client.input.size() - lineStart > maxLineBytes) {
+                    close(id);
+                    return;
+                }
+                continue;
+            }
+            if (n == 0) {
+                client.closing = true;
+                break;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            close(id);
+            return;
+        }
+
+        size_t begin = 0;
+        for (size_t end; (end = client.input.find('\n', begin)) != std::string::npos; begin = end + 1) {
+            size_t length = end - begin;
+            if (length > 0 && client.input[end - 1] == '\r') --length;
+            if (length > 0) client.pending.emplace_back(client.input, begin, length);
+        }
+        client.input.erase(0, begin);
+
+        if (!client.busy && !client.pending.empty())
+            dispatch(id);
+        else if (client.closing && !client.busy && client.output.empty()) {
+            close(id);
+            return;
+        }
+        watch(id);
+    }
+
+    void CurveServer::write(uint64_t id) {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) return;
+        Connection& client = it->second;
+
+        size_t sent = 0;
+        while (sent < client.output.size()) {
+            ssize_t n = ::send(client.fd, client.output.data() + sent, client.output.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            close(id);
+            return;
+        }
+        client.output.erase(0, sent);
+
+        if (client.closing && !client.busy && client.pending.empty() && client.output.empty()) {
+            close(id);
+            return;
+        }
+        watch(id);
+    }
+
+    void CurveServer::dispatch(uint64_t id) {
+        Connection& client = connections_.at(id);
+        client.busy        = true;
+        std::vector<std::string> lines;
+        lines.swap(client.pending);
+        pool_->submit([this, id, lines = std::move(lines)]() {
+            std::string output;
+            for (const auto& line : lines) {
+                output += handleLine(line);
+                output += '\n';
+            }
+            {
+                std::lock_guard<std::mutex> lock(completionsMutex_);
+                completions_.push_back({id, std::move(output)});
+            }
+            uint64_t one                     = 1;
+            [[maybe_unused]] ssize_t written = ::write(wakeup_, &one, sizeof(one));
+        });
+    }
+
+    void CurveServer::complete() {
+        std::deque<Completion> done;
+        {
+            std::lock_guard<std::mutex> lock(completionsMutex_);
+            done.swap(completions_);
+        }
+        for (auto& completion : done) {
+            // the connection may have been closed while its task was running
+            auto it = connections_.find(completion.connection);
+            if (it == connections_.end()) continue;
+            Connection& client = it->second;
+            client.busy        = false;
+            client.output += completion.output;
+            // lines that arrived meanwhile go out before the answers are written, so that both overlap
+            if (!client.pending.empty()) dispatch(completion.connection);
+            write(completion.connection);
+        }
+    }
+
+    void CurveServer::close(uint64_t id) {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) return;
+        ::epoll_ctl(epoll_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        connections_.erase(it);
+        pauseAccept(false);
+    }
+
+    void CurveServer::pauseAccept(bool paused) {
+        if (paused == acceptPaused_) return;
+        for (size_t i = 0; i < listeners_.size(); ++i) {
+            epoll_event event{};
+            event.events   = paused ? 0 : EPOLLIN;
+            event.data.u64 = listenerTag | i;
+            ::epoll_ctl(epoll_, EPOLL_CTL_MOD, listeners_[i], &event);
+        }
+        acceptPaused_ = paused;
+    }
+
+    void CurveServer::watch(uint64_t id) {
+        Connection& client = connections_.at(id);
+        uint32_t events    = (client.closing ? 0 : EPOLLIN) | (client.output.empty() ? 0 : EPOLLOUT);
+        if (events == client.events) return;
+        epoll_event event{};
+        event.events   = events;
+        event.data.u64 = id;
+        if (::epoll_ctl(epoll_, EPOLL_CTL_MOD, client.fd, &event) != 0) {
+            close(id);
+            return;
+        }
+        client.events = events;
+    }
+
+    std::string CurveServer::handleLine(const std::string& line) {
+        json request;
+        try {
+            request = json::parse(line);
+        }
+        catch (const std::exception& e) {
+            requests_.fetch_add(1, std::memory_order_relaxed);
+            errors_.fetch_add(1, std::memory_order_relaxed);
+            return dump({{"ID", nullptr}, {"ERROR", std::string("Invalid JSON: ") + e.what()}});
+        }
+        if (!request.is_array()) return dump(handle(request));
+
+        json answers = json::array();
+        for (const auto& element : request) answers.push_back(handle(element));
+        return dump(answers);
+    }
+
+    json CurveServer::handle(const json& request) {
+        json answer = {{"ID", request.is_object() && request.contains("ID") ? request.at("ID") : json()}};
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            if (!request.is_object()) throw std::runtime_error("A request must be a JSON object");
+            const std::string& type = request.at("TYPE");
+            const json& body        = request.at("BODY");
+            if (type == "UPDATEQUOTES") {
+                std::lock_guard<std::mutex> lock(updateMutex_);
+                answer["RESULT"] = builder_.updateQuotes(body);
+                return answer;
+            }
+
+            if (type == "DISCOUNT")
+                answer["RESULT"] = marketStore_.discountRequest(body);
+            else if (type == "ZERORATE")
+                answer["RESULT"] = marketStore_.zeroRateRequest(body);
+            else if (type == "FORWARDRATE")
+                answer["RESULT"] = marketStore_.forwardRateRequest(body);
+            else
+                throw std::runtime_error("Unknown request type: " + type);
+        }
+        catch (const std::exception& e) {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+            answer["ERROR"] = e.what();
+        }
+        return answer;
+    }
+}  // namespace CurveManager
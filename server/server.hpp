@@ -0,0 +1,112 @@
+#ifndef C933DCA8_78CF_4B52_ACB3_7128DDA9A9F9
+#define C933DCA8_78CF_4B52_ACB3_7128DDA9A9F9
+
+#include <curvemanager/curvemanager.hpp>
+#include "utils/threadpool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CurveManager
+{
+    struct ServerStats {
+        uint64_t connections = 0;  // accepted so far
+        uint64_t requests    = 0;  // answered, counting each element of a batch
+        uint64_t errors      = 0;  // answered with an ERROR
+    };
+
+    /*
+     * Curve query server on a TCP or Unix domain socket, driven by an epoll event loop (Linux only).
+     *
+     * The protocol is one JSON document per line. A request is {"ID": any, "TYPE": type, "BODY": body}
+     * with type DISCOUNT, ZERORATE, FORWARDRATE (the body of MarketStore::discountRequest and friends) or
+     * UPDATEQUOTES (the prices of CurveBuilder::updateQuotes); the answer is {"ID": id, "RESULT": result}
+     * or {"ID": id, "ERROR": message}. A line holding an array of requests is a batch, answered with the
+     * array of answers on one line.
+     *
+     * Clients may pipeline: every complete line read from a connection is queued, and the lines of a
+     * connection are handed to the query pool together, as one task, while no other task of the same
+     * connection is running. Answers thus come back in request order and an update is seen by the queries
+     * sent after it, while different connections are served concurrently. The store is switched to versioned
+     * mode: queries read the published epoch without locking, and quote updates run one at a time while the
+     * queries keep reading the previous epoch until the new one is published.
+     */
+    class CurveServer {
+       public:
+        CurveServer(CurveBuilder& builder, MarketStore& marketStore, size_t nThreads = 0);
+        ~CurveServer();
+
+        CurveServer(const CurveServer&)            = delete;
+        CurveServer& operator=(const CurveServer&) = delete;
+
+        // both may be called before run, to serve on several sockets; port 0 picks a free port, returned
+        uint16_t listenTCP(const std::string& host, uint16_t port);
+        void listenUnix(const std::string& path);
+
+        // serves until stop is called, from any thread (or a signal handler)
+        void run();
+        void stop();
+
+        // answer to one request line, as sent back to the client (without the line break)
+        std::string handleLine(const std::string& line);
+        json handle(const json& request);
+
+        ServerStats stats() const;
+
+       private:
+        struct Connection {
+            int fd;
+            std::string input;                 // bytes read, up to the last incomplete line
+            std::string output;                // answers not written yet
+            std::vector<std::string> pending;  // complete lines waiting for the pool
+            uint32_t events = 0;               // registered with epoll
+            bool busy       = false;           // a task of the connection is running
+            bool closing    = false;           // the peer closed its side: close once the answers are out
+        };
+
+        struct Completion {
+            uint64_t connection;
+            std::string output;
+        };
+
+        void accept(int listener);
+        void read(uint64_t id);
+        void write(uint64_t id);
+        void dispatch(uint64_t id);
+        void complete();
+        void close(uint64_t id);
+        void watch(uint64_t id);
+        void addListener(int fd);
+        void pauseAccept(bool paused);
+
+        CurveBuilder& builder_;
+        MarketStore& marketStore_;
+        std::mutex updateMutex_;  // quote updates rebootstrap the live curves
+
+        int epoll_  = -1;
+        int wakeup_ = -1;  // eventfd written by the workers and by stop
+        std::vector<int> listeners_;
+        std::vector<std::string> unixPaths_;
+        std::unordered_map<uint64_t, Connection> connections_;  // owned by the event loop thread
+        uint64_t nextConnection_ = 0;
+        bool acceptPaused_       = false;  // out of descriptors: listeners disarmed
+        std::atomic<bool> stopping_{false};
+
+        std::mutex completionsMutex_;
+        std::deque<Completion> completions_;
+
+        std::atomic<uint64_t> accepted_{0};
+        std::atomic<uint64_t> requests_{0};
+        std::atomic<uint64_t> errors_{0};
+
+        // reset first on destruction, so that no task outlives the members it uses
+        std::unique_ptr<utils::ThreadPool> pool_;
+    };
+}  // namespace CurveManager
+
+#endif /* C933DCA8_78CF_4B52_ACB3_7128DDA9A9F9 */
@@ -1,21 +1,102 @@
 
 #include <curvemanager/curvemanager.hpp>
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/schemaregistry.hpp>
 #include <curvemanager/schemas/all.hpp>
 #include <qlp/schemas/ratehelpers/all.hpp>
 #include <qlp/schemas/termstructures/all.hpp>
+#include "utils/mappedfile.hpp"
+#include "utils/threadpool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <istream>
 
 namespace CurveManager
 {
     using namespace QuantExt;
     using namespace QuantLibParser;
 
-    CurveBuilder::CurveBuilder(const json& data, MarketStore& marketStore) : data_(data), marketStore_(marketStore) {
-        Schema<CurveBuilderRequest> schema;
-        schema.validate(data_);
-        if (!data_.empty()) preprocessData();
+    namespace
+    {
+#ifdef CURVEMANAGER_METRICS
+        uint64_t quoteReads(const std::vector<boost::shared_ptr<RateHelper>>& helpers) {
+            uint64_t reads = 0;
+            for (const auto& helper : helpers) {
+                auto quote = boost::dynamic_pointer_cast<CountingQuote>(helper->quote().currentLink());
+                if (quote) reads += quote->reads();
+            }
+            return reads;
+        }
+#endif
+
+        double elapsedMs(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // runs f(i) for every i in [0, n), in contiguous chunks on nThreads workers (0 means one per core)
+        template <typename F>
+        void parallelFor(size_t n, size_t nThreads, const F& f) {
+            if (nThreads == 0) nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            nThreads = std::min(nThreads, n);
+            if (nThreads <= 1) {
+                for (size_t i = 0; i < n; ++i) f(i);
+                return;
+            }
+            utils::ThreadPool pool(nThreads);
+            std::vector<std::future<void>> tasks;
+            size_t chunk = (n + nThreads - 1) / nThreads;
+            for (size_t begin = 0; begin < n; begin += chunk) {
+                size_t end = std::min(n, begin + chunk);
+                tasks.push_back(pool.submit([&f, begin, end]() {
+                    for (size_t i = begin; i < end; ++i) f(i);
+                }));
+            }
+            utils::waitAll(tasks);
+        }
+
+        void validateBlock(const json_validator& validator, const json& block) {
+            try {
+                validator.validate(block);
+            }
+            catch (const std::exception& e) {
+                std::string error = e.what();
+                throw std::runtime_error("Validation of schema failed:\t" + error + "\n");
+            }
+        }
+    }  // namespace
+
+    json readCurveConfig(const std::string& path) {
+        utils::MappedFile file(path);
+        return json::parse(file.data(), file.data() + file.size());
+    }
+
+    json readCurveConfig(std::istream& stream) {
+        return json::parse(stream);
+    }
+
+    CurveBuilder::CurveBuilder(json data, MarketStore& marketStore, size_t nThreads) : marketStore_(marketStore) {
+        auto start = std::chrono::steady_clock::now();
+        if (!marketStore_.isTrustedInput()) {
+            CURVEMANAGER_TIME_SCOPE(marketStore_.metricsRegistry(), Timing::CurveConfigValidation);
+            cachedSchema<CurveBuilderRequest>().validate(data);
+        }
+        configLoadTimes_.validateMs = elapsedMs(start);
+        if (!data.empty()) {
+            refDate_ = cachedParseDate(data.at("REFDATE"));
+            // building the indexes registers them on the evaluation date
+            EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+            preprocessData(data, nThreads);
+        }
     };
 
-    void CurveBuilder::preprocessData() {
+    CurveBuilder::~CurveBuilder() {
+        // the coupons of the helpers are registered on the evaluation date
+        EvaluationDateLock lock;
+        curveHelpers_.clear();
+        jacobianHelpers_.clear();
+    };
+
+    void CurveBuilder::preprocessData(json& data, size_t nThreads) {
         json curveValidation = R"({
             "title": "Curve type",
             "type": "object",
@@ -25,65 +106,260 @@ namespace CurveManager
 
         curveValidation["properties"]["TYPE"] = curveTypeSchema;
         curveValidation["properties"]["NAME"] = curveNameSchema;
-        json_validator validator;
+        const json_validator& validator       = cachedValidator("CurveType", curveValidation);
 
-        Schema<DiscountCurve> discountCurveSchema;
-        Schema<BootstrapCurve> bootstrapCurveSchema;
-        Schema<FlatForward> flatForwardSchema;
+        json interpolationValidation = R"({
+            "title": "Piecewise curve interpolation",
+            "type": "object",
+            "properties": {}
+            })"_json;
 
-        for (auto& curve : data_.at("CURVES")) {
-            try {
-                validator.set_root_schema(curveValidation);  // insert root-schema
-                validator.validate(curve);
-            }
-            catch (const std::exception& e) {
-                std::string error = e.what();
-                throw std::runtime_error("Validation of schema failed:\t" + error + "\n");
+        interpolationValidation["properties"]["TRAITS"]["enum"]        = configNames(PiecewiseTraits());
+        interpolationValidation["properties"]["INTERPOLATION"]["enum"] = configNames(PiecewiseInterpolators());
+        const json_validator& interpolationValidator                   = cachedValidator("PiecewiseInterpolation", interpolationValidation);
+
+        auto& discountCurveSchema  = cachedSchema<DiscountCurve>();
+        auto& bootstrapCurveSchema = cachedSchema<BootstrapCurve>();
+        auto& flatForwardSchema    = cachedSchema<FlatForward>();
+        auto& indexSchema          = cachedSchema<IborIndex>();
+
+        json& curves  = data.at("CURVES");
+        json& indexes = data.at("INDEXES");
+        auto start    = std::chrono::steady_clock::now();
+        bool trusted  = marketStore_.isTrustedInput();
+
+        // the blocks are independent and the schemas are only read, so they are validated and defaulted in place
+        // concurrently; the store is not touched until the workers are done
+        parallelFor(curves.size() + indexes.size(), nThreads, [&](size_t i) {
+            CURVEMANAGER_TIME_SCOPE(marketStore_.metricsRegistry(), Timing::CurveConfigValidation);
+            if (i >= curves.size()) {
+                json& index = indexes[i - curves.size()];
+                if (!trusted) indexSchema.validate(index);
+                index = indexSchema.setDefaultValues(std::move(index));
+                return;
             }
 
-            if (curve.at("TYPE") == "DISCOUNT") {
-                discountCurveSchema.setDefaultValues(curve);
-                discountCurveSchema.validate(curve);
+            json& curve = curves[i];
+            if (!trusted) validateBlock(validator, curve);
+            std::string type = curve.at("TYPE");
+            if (type == "DISCOUNT") {
+                curve = discountCurveSchema.setDefaultValues(std::move(curve));
+                if (!trusted) discountCurveSchema.validate(curve);
             }
-            else if (curve.at("TYPE") == "FLATFORWARD") {
-                flatForwardSchema.setDefaultValues(curve);
-                flatForwardSchema.validate(curve);
+            else if (type == "FLATFORWARD") {
+                curve = flatForwardSchema.setDefaultValues(std::move(curve));
+                if (!trusted) flatForwardSchema.validate(curve);
             }
-            else if (curve.at("TYPE") == "PIECEWISE") {
-                bootstrapCurveSchema.setDefaultValues(curve);
-                bootstrapCurveSchema.validate(curve);
+            else if (type == "PIECEWISE") {
+                curve = bootstrapCurveSchema.setDefaultValues(std::move(curve));
+                if (!trusted) {
+                    bootstrapCurveSchema.validate(curve);
+                    validateBlock(interpolationValidator, curve);
+                }
+                if (!curve.contains("TRAITS")) curve["TRAITS"] = ConfigName<Discount>::value;
+                if (!curve.contains("INTERPOLATION")) curve["INTERPOLATION"] = ConfigName<LogLinear>::value;
             }
-            const std::string& name = curve.at("NAME");
-            curveConfigs_[name]     = curve;
+        });
+        configLoadTimes_.validateMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        curveConfigs_.reserve(curves.size());
+        for (auto& curve : curves) {
+            std::string name = curve.at("NAME");
             RelinkableHandle<YieldTermStructure> handle;
             marketStore_.addCurveHandle(name, handle);
+            curveConfigs_[name] = std::move(curve);
         }
-        Schema<IborIndex> indexSchema;
-        for (auto& index : data_.at("INDEXES")) {
-            indexSchema.validate(index);
-            indexSchema.setDefaultValues(index);
-
-            const std::string& name = index.at("NAME");
-            indexConfigs_[name]     = index;
+        indexConfigs_.reserve(indexes.size());
+        for (auto& index : indexes) {
+            std::string name    = index.at("NAME");
+            indexConfigs_[name] = std::move(index);
             buildIndex(name);
         }
+        buildDependencies();
+        configLoadTimes_.preprocessMs = elapsedMs(start);
+    }
+
+    void CurveBuilder::buildDependencies() {
+        // indexes are forecast on the curve with the same name, so any non-ticker field of a rate helper naming
+        // another curve (INDEX, DISCOUNTINGCURVE, COLLATERALCURVE, SHORTINDEX, ...) is a dependency.
+        for (const auto& [name, curve] : curveConfigs_) {
+            auto& dependencies = curveDependencies_[name];
+            if (!curve.contains("RATEHELPERS")) continue;
+            for (const auto& helper : curve.at("RATEHELPERS")) {
+                for (auto it = helper.begin(); it != helper.end(); ++it) {
+                    if (!it.value().is_string() || it.key().ends_with("TICKER")) continue;
+                    std::string other = it.value();
+                    if (other != name && curveConfigs_.find(other) != curveConfigs_.end()) {
+                        dependencies.insert(other);
+                        curveDependents_[other].insert(name);
+                    }
+                }
+            }
+        }
+    }
+
+    const std::set<std::string>& CurveBuilder::curveDependencies(const std::string& name) const {
+        auto it = curveDependencies_.find(name);
+        if (it == curveDependencies_.end()) throw std::runtime_error("Curve not found: " + name);
+        return it->second;
+    }
+
+    std::vector<std::vector<std::string>> CurveBuilder::buildWaves() const {
+        std::unordered_map<std::string, size_t> pending;
+        std::unordered_map<std::string, std::vector<std::string>> dependents;
+        for (const auto& [name, dependencies] : curveDependencies_) {
+            pending[name] = dependencies.size();
+            for (const auto& dependency : dependencies) dependents[dependency].push_back(name);
+        }
+
+        std::vector<std::vector<std::string>> waves;
+        std::vector<std::string> wave;
+        for (const auto& [name, count] : pending)
+            if (count == 0) wave.push_back(name);
+
+        size_t scheduled = 0;
+        while (!wave.empty()) {
+            std::sort(wave.begin(), wave.end());
+            std::vector<std::string> next;
+            for (const auto& name : wave) {
+                auto it = dependents.find(name);
+                if (it == dependents.end()) continue;
+                for (const auto& dependent : it->second)
+                    if (--pending[dependent] == 0) next.push_back(dependent);
+            }
+            scheduled += wave.size();
+            waves.push_back(std::move(wave));
+            wave = std::move(next);
+        }
+
+        if (scheduled != pending.size()) {
+            std::string cycle;
+            for (const auto& [name, count] : pending)
+                if (count > 0) cycle += " " + name;
+            throw std::runtime_error("Circular dependency between curves:" + cycle);
+        }
+        return waves;
+    }
+
+    const std::unordered_map<std::string, double>& CurveBuilder::buildTimes() const {
+        return buildTimes_;
+    }
+
+    const ConfigLoadTimes& CurveBuilder::configLoadTimes() const {
+        return configLoadTimes_;
+    }
+
+    const Date& CurveBuilder::referenceDate() const {
+        return refDate_;
+    }
+
+    void CurveBuilder::setWarmStart(bool enabled, double bracketWidth) {
+        warmStart_      = enabled;
+        warmStartWidth_ = bracketWidth;
     }
 
     void CurveBuilder::build() {
-        const std::string& refDate            = data_.at("REFDATE");
-        Settings::instance().evaluationDate() = parse<Date>(refDate);
-        for (const auto& [name, curve] : curveConfigs_) buildCurve(name, curve);
+        {
+            EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+            for (const auto& [name, curve] : curveConfigs_) buildCurve(name, curve);
+        }
+        {
+            // the bootstraps only read the objects built above, so builders sharing the date run them concurrently
+            EvaluationDateLock lock(refDate_);
+            for (const auto& wave : buildWaves()) {
+                for (const auto& name : wave) {
+                    auto curve = marketStore_.getCurve(name);
+                    auto it    = curveHelpers_.find(name);
+                    if (it != curveHelpers_.end())
+                        timedBootstrap(name, it->second, [&]() { curve->discount(0.0, true); });
+                    else
+                        curve->discount(0.0, true);
+                }
+            }
+            if (marketStore_.isVersioned()) marketStore_.publishSnapshot();
+        }
+        // outside the shared hold: the Jacobians take the date exclusively to build their helpers
+        if (jacobianMode_)
+            for (const auto& [name, helpers] : curveHelpers_)
+                if (supportsJacobian(name)) computeJacobian(name);
+    };
+
+    void CurveBuilder::buildParallel(size_t nThreads) {
+        // IndexManager is written here, on the calling thread, so that the workers only read it (the fixings
+        // lookup of an index inserts its history on first use); with per thread Settings they get a copy
+        EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+        for (const auto& name : marketStore_.allIndexes()) marketStore_.getIndex(name)->timeSeries();
+        EvaluationDateLock::Context context = EvaluationDateLock::capture(refDate_);
+
+        buildTimes_.clear();
+        auto waves = buildWaves();
+        utils::ThreadPool pool(nThreads);
+        for (const auto& wave : waves) {
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(wave.size());
+            for (const auto& name : wave) {
+                tasks.push_back(pool.submit([this, &name, &context]() {
+                    EvaluationDateLock::inherit(context);
+                    bootstrapCurve(name);
+                }));
+            }
+            utils::waitAll(tasks);
+        }
+        // computing a Jacobian builds helpers, so it is not done from the workers
+        if (jacobianMode_)
+            for (const auto& [name, helpers] : curveHelpers_)
+                if (supportsJacobian(name)) computeJacobian(name);
+        if (marketStore_.isVersioned()) marketStore_.publishSnapshot();
+    };
+
+    void CurveBuilder::bootstrapCurve(const std::string& name) {
+        auto start = std::chrono::steady_clock::now();
+        boost::shared_ptr<YieldTermStructure> curve;
+        std::vector<boost::shared_ptr<RateHelper>> helpers;
+        {
+            // building the helpers registers observers on shared quotes, handles and on the evaluation date
+            std::lock_guard<std::mutex> lock(buildMutex_);
+            buildCurve(name, curveConfigs_.at(name));
+            curve   = marketStore_.getCurve(name);
+            auto it = curveHelpers_.find(name);
+            if (it != curveHelpers_.end()) helpers = it->second;
+        }
+        // forces the lazy bootstrap; the dependencies were bootstrapped in a previous wave and are only read
+        timedBootstrap(name, helpers, [&]() { curve->discount(0.0, true); });
+        double elapsed = elapsedMs(start);
+
+        std::lock_guard<std::mutex> lock(buildMutex_);
+        buildTimes_[name] = elapsed;
     };
 
+    double CurveBuilder::timedBootstrap([[maybe_unused]] const std::string& name,
+                                        [[maybe_unused]] const std::vector<boost::shared_ptr<RateHelper>>& helpers,
+                                        const std::function<void()>& bootstrap) {
+#ifdef CURVEMANAGER_METRICS
+        // quotes shared with curves bootstrapped concurrently make the iteration count an upper bound
+        uint64_t reads = quoteReads(helpers);
+#endif
+        auto start = std::chrono::steady_clock::now();
+        bootstrap();
+        double elapsed = elapsedMs(start);
+#ifdef CURVEMANAGER_METRICS
+        marketStore_.metricsRegistry().recordBootstrap(name, elapsed, quoteReads(helpers) - reads, helpers.size());
+#endif
+        return elapsed;
+    }
+
     void CurveBuilder::buildCurve(const std::string& curveName, const json& curveParams) {
         if (!marketStore_.hasCurve(curveName)) {
             const std::string& curveType = curveParams.at("TYPE");
             boost::shared_ptr<YieldTermStructure> curvePtr;
+            BootstrappedCurve bootstrapped;
             if (curveType == "DISCOUNT") {
                 curvePtr = buildDiscountCurve(curveName, curveParams);
             }
             else if (curveType == "PIECEWISE") {
-                curvePtr = buildPiecewiseCurve(curveName, curveParams);
+                bootstrapped = buildPiecewiseCurve(curveName, curveParams);
+                curvePtr     = bootstrapped.termStructure();
             }
             else if (curveType == "FLATFORWARD") {
                 curvePtr = buildFlatForwardCurve(curveName, curveParams);
@@ -94,28 +370,46 @@ namespace CurveManager
             handle.linkTo(curvePtr);
 
             curvePtr->unregisterWith(Settings::instance().evaluationDate());
-            marketStore_.addCurve(curveName, curvePtr);
+            if (bootstrapped)
+                marketStore_.addCurve(curveName, bootstrapped);
+            else
+                marketStore_.addCurve(curveName, curvePtr);
         }
     }
 
-    boost::shared_ptr<YieldTermStructure> CurveBuilder::buildPiecewiseCurve(const std::string& curveName, const json& curveParams) {
-        auto helpers          = buildRateHelpers(curveParams.at("RATEHELPERS"), curveName);
-        DayCounter dayCounter = parse<DayCounter>(curveParams.at("DAYCOUNTER"));
-        Date qlRefDate        = Settings::instance().evaluationDate();
-        boost::shared_ptr<YieldTermStructure> curvePtr(new PiecewiseYieldCurve<Discount, LogLinear>(qlRefDate, helpers, dayCounter));
-        return curvePtr;
+    BootstrappedCurve CurveBuilder::buildPiecewiseCurve(const std::string& curveName, const json& curveParams) {
+        auto helpers                     = buildRateHelpers(curveParams.at("RATEHELPERS"), curveName);
+        DayCounter dayCounter            = parse<DayCounter>(curveParams.at("DAYCOUNTER"));
+        const std::string& traits        = curveParams.at("TRAITS");
+        const std::string& interpolation = curveParams.at("INTERPOLATION");
+        auto seed                        = warmStart_ ? marketStore_.curveSeed(curveName) : nullptr;
+
+        // the names are matched against the type lists once, here; the store only sees the erased curve
+        BootstrappedCurve curve;
+        dispatchByName(PiecewiseTraits(), traits, [&](auto traitsTag) {
+            dispatchByName(PiecewiseInterpolators(), interpolation, [&](auto interpolatorTag) {
+                using Interpolator = typename decltype(interpolatorTag)::type;
+                using Curve        = PiecewiseCurve<typename decltype(traitsTag)::type, Interpolator>;
+                WarmStartBootstrap<Curve> bootstrap(warmStart_, warmStartWidth_, seed);
+                boost::shared_ptr<Curve> curvePtr(new Curve(refDate_, helpers, dayCounter, Interpolator(), bootstrap));
+                curve = BootstrappedCurve(curvePtr);
+            });
+        });
+        if (!curve)
+            throw std::runtime_error("Error building curve " + curveName + ": unknown TRAITS or INTERPOLATION " + traits + "/" + interpolation);
+        curveHelpers_[curveName] = helpers;
+        return curve;
     };
 
     boost::shared_ptr<YieldTermStructure> CurveBuilder::buildDiscountCurve(const std::string& curveName, const json& curveParams) {
-        Date qlRefDate    = Settings::instance().evaluationDate();
         const json& nodes = curveParams.at("NODES");
         std::vector<Date> dates;
         std::vector<double> dfs;
         for (const auto& node : nodes) {
-            dates.push_back(parse<Date>(node.at("DATE")));
+            dates.push_back(cachedParseDate(node.at("DATE")));
             dfs.push_back(node.at("VALUE"));
         }
-        if (qlRefDate != dates[0])
+        if (refDate_ != dates[0])
             throw std::runtime_error("Error building curve" + curveName +
                                      ": Reference date (REFDATE) must be equal to the first node date (NODES/DATES) in the curve.");
 
@@ -129,50 +423,106 @@ namespace CurveManager
         Compounding compounding = parse<Compounding>(curveParams.at("COMPOUNDING"));
         Frequency frequency     = parse<Frequency>(curveParams.at("FREQUENCY"));
         double rate             = curveParams.at("RATE");
-        Date qlRefDate          = Settings::instance().evaluationDate();
-        boost::shared_ptr<YieldTermStructure> curvePtr(new FlatForward(qlRefDate, rate, dayCounter, compounding, frequency));
+        boost::shared_ptr<YieldTermStructure> curvePtr(new FlatForward(refDate_, rate, dayCounter, compounding, frequency));
         return curvePtr;
     };
 
-    void CurveBuilder::updateQuotes(const json& prices) {
-        Schema<UpdateQuoteRequest> schema;
-        schema.validate(prices);
+    std::vector<std::string> CurveBuilder::updateQuotes(const json& prices) {
+        if (!marketStore_.isTrustedInput()) {
+            CURVEMANAGER_TIME_SCOPE(marketStore_.metricsRegistry(), Timing::QuoteUpdateValidation);
+            cachedSchema<UpdateQuoteRequest>().validate(prices);
+        }
+        std::vector<QuoteId> quotes;
+        std::vector<double> values;
+        quotes.reserve(prices.size());
+        values.reserve(prices.size());
         for (const auto& pair : prices) {
-            std::string curveName = pair.at("NAME");
-            if (!marketStore_.hasQuote(curveName)) {
-                throw std::runtime_error("No quote found for " + curveName);
+            quotes.push_back(marketStore_.quoteId(pair.at("NAME").get<std::string>()));
+            values.push_back(pair.at("VALUE").get<double>());
+        }
+        return updateQuotes(quotes, values);
+    }
+
+    std::vector<std::string> CurveBuilder::updateQuotes(const std::vector<QuoteId>& quotes, const std::vector<double>& values) {
+        CURVEMANAGER_TIME_SCOPE(marketStore_.metricsRegistry(), Timing::QuoteUpdate);
+        if (quotes.size() != values.size()) throw std::runtime_error("Quotes and values must have the same size");
+
+        // only the affected curves are frozen, so that unfreezing does not invalidate the rest of the store
+        std::vector<std::string> affected = affectedCurves(quotes);
+        {
+            EvaluationDateLock lock(refDate_);
+            marketStore_.freeze(affected);
+            for (size_t i = 0; i < quotes.size(); ++i) {
+                boost::shared_ptr<SimpleQuote> quote = boost::static_pointer_cast<SimpleQuote>(marketStore_.getQuote(quotes[i]).currentLink());
+                quote->setValue(values[i]);
             }
+            marketStore_.unfreeze(affected);
+            for (const auto& name : affected) {
+                auto it = curveHelpers_.find(name);
+                if (it != curveHelpers_.end())
+                    timedBootstrap(name, it->second, [&]() { marketStore_.recalculate({name}); });
+                else
+                    marketStore_.recalculate({name});
+            }
+            if (marketStore_.isVersioned()) marketStore_.publishSnapshot(affected);
         }
+        if (jacobianMode_)
+            for (const auto& name : affected)
+                if (supportsJacobian(name)) computeJacobian(name);
+        return affected;
+    }
 
-        marketStore_.freeze();
-        for (const auto& pair : prices) {
-            Handle<Quote> handle                 = marketStore_.getQuote(pair.at("NAME"));
-            boost::shared_ptr<SimpleQuote> quote = boost::static_pointer_cast<SimpleQuote>(handle.currentLink());
-            quote->setValue(pair["VALUE"]);
+    std::vector<std::string> CurveBuilder::affectedCurves(const std::set<std::string>& tickers) const {
+        std::vector<QuoteId> quotes;
+        for (const auto& ticker : tickers)
+            if (marketStore_.hasQuote(ticker)) quotes.push_back(marketStore_.quoteId(ticker));
+        return affectedCurves(quotes);
+    }
+
+    std::vector<std::string> CurveBuilder::affectedCurves(const std::vector<QuoteId>& quotes) const {
+        std::set<std::string> affected;
+        std::vector<std::string> pending;
+        for (QuoteId quote : quotes)
+            if (quote < quoteCurves_.size()) pending.insert(pending.end(), quoteCurves_[quote].begin(), quoteCurves_[quote].end());
+        while (!pending.empty()) {
+            std::string name = std::move(pending.back());
+            pending.pop_back();
+            if (!affected.insert(name).second) continue;
+            auto it = curveDependents_.find(name);
+            if (it != curveDependents_.end()) pending.insert(pending.end(), it->second.begin(), it->second.end());
         }
-        marketStore_.unfreeze();
+
+        std::vector<std::string> ordered;
+        for (const auto& wave : buildWaves())
+            for (const auto& name : wave)
+                if (affected.find(name) != affected.end() && marketStore_.hasCurve(name)) ordered.push_back(name);
+        return ordered;
     }
 
-    std::vector<boost::shared_ptr<RateHelper>> CurveBuilder::buildRateHelpers(const json& rateHelperVector, const std::string& currentCurve) {
+    std::vector<boost::shared_ptr<RateHelper>> CurveBuilder::buildRateHelpers(const json& rateHelperVector,
+                                                                              const std::string& currentCurve,
+                                                                              RelinkableHandle<YieldTermStructure>* ownHandle) {
         PriceGetter priceGetter = [&](double price, const std::string& ticker) {
             if (!marketStore_.hasQuote(ticker)) {
-                boost::shared_ptr<Quote> quote(new SimpleQuote(price));
+                boost::shared_ptr<Quote> quote = makeStoreQuote(price);
                 Handle<Quote> handle(quote);
                 marketStore_.addQuote(ticker, handle);
-                return handle;
-            }
-            else {
-                return marketStore_.getQuote(ticker);
             }
+            QuoteId id = marketStore_.quoteId(ticker);
+            if (id >= quoteCurves_.size()) quoteCurves_.resize(id + 1);
+            quoteCurves_[id].insert(currentCurve);
+            return marketStore_.getQuote(id);
         };
 
         IndexGetter indexGetter = [&](const std::string& indexName) {
             if (currentCurve != indexName) buildCurve(indexName, curveConfigs_.at(indexName));
+            if (ownHandle && currentCurve == indexName) return marketStore_.getIndex(indexName)->clone(*ownHandle);
             return marketStore_.getIndex(indexName);
         };
 
         CurveGetter curveGetter = [&](const std::string& curveName) {
             if (currentCurve != curveName) buildCurve(curveName, curveConfigs_.at(curveName));
+            if (ownHandle && currentCurve == curveName) return *ownHandle;
             return marketStore_.getCurveHandle(curveName);
         };
 
@@ -184,36 +534,36 @@ namespace CurveManager
             boost::shared_ptr<RateHelper> helper;
             try {
                 if (type == "DEPOSIT") {
-                    Schema<DepositRateHelper> schema;
-                    helper = boost::make_shared<DepositRateHelper>(schema.makeObj(helperParams, priceGetter));
+                    auto& schema = cachedSchema<DepositRateHelper>();
+                    helper       = boost::make_shared<DepositRateHelper>(schema.makeObj(helperParams, priceGetter));
                 }
                 else if (type == "FXSWAP") {
-                    Schema<FxSwapRateHelper> schema;
-                    helper = boost::make_shared<FxSwapRateHelper>(schema.makeObj(helperParams, priceGetter, curveGetter));
+                    auto& schema = cachedSchema<FxSwapRateHelper>();
+                    helper       = boost::make_shared<FxSwapRateHelper>(schema.makeObj(helperParams, priceGetter, curveGetter));
                 }
                 else if (type == "BOND") {
-                    Schema<FixedRateBondHelper> schema;
-                    helper = boost::make_shared<FixedRateBondHelper>(schema.makeObj(helperParams, priceGetter));
+                    auto& schema = cachedSchema<FixedRateBondHelper>();
+                    helper       = boost::make_shared<FixedRateBondHelper>(schema.makeObj(helperParams, priceGetter));
                 }
                 else if (type == "SWAP") {
-                    Schema<SwapRateHelper> schema;
-                    helper = boost::make_shared<SwapRateHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
+                    auto& schema = cachedSchema<SwapRateHelper>();
+                    helper       = boost::make_shared<SwapRateHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
                 }
                 else if (type == "OIS") {
-                    Schema<OISRateHelper> schema;
-                    helper = boost::make_shared<OISRateHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
+                    auto& schema = cachedSchema<OISRateHelper>();
+                    helper       = boost::make_shared<OISRateHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
                 }
                 else if (type == "XCCY") {
-                    Schema<CrossCcyFixFloatSwapHelper> schema;
-                    helper = boost::make_shared<CrossCcyFixFloatSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
+                    auto& schema = cachedSchema<CrossCcyFixFloatSwapHelper>();
+                    helper       = boost::make_shared<CrossCcyFixFloatSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
                 }
                 else if (type == "XCCYBASIS") {
-                    Schema<CrossCcyBasisSwapHelper> schema;
-                    helper = boost::make_shared<CrossCcyBasisSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
+                    auto& schema = cachedSchema<CrossCcyBasisSwapHelper>();
+                    helper       = boost::make_shared<CrossCcyBasisSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
                 }
                 else if (type == "TENORBASIS") {
-                    Schema<TenorBasisSwapHelper> schema;
-                    helper = boost::make_shared<TenorBasisSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
+                    auto& schema = cachedSchema<TenorBasisSwapHelper>();
+                    helper       = boost::make_shared<TenorBasisSwapHelper>(schema.makeObj(helperParams, priceGetter, indexGetter, curveGetter));
                 }
                 else {
                     throw std::runtime_error("Helper of type " + type + " not supported");
@@ -0,0 +1,185 @@
+#include <curvemanager/curvesnapshot.hpp>
+#include <curvemanager/marketstore.hpp>
+#include <ql/termstructures/yield/discountcurve.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <unordered_set>
+
+namespace CurveManager
+{
+    CompiledCurve::CompiledCurve(const Date& referenceDate, const DayCounter& dayCounter, std::vector<double> times, std::vector<double> logDiscounts)
+    : referenceDate_(referenceDate), dayCounter_(dayCounter), times_(std::move(times)), logDiscounts_(std::move(logDiscounts)) {
+        computeSlopes();
+    }
+
+    namespace
+    {
+        template <typename Curve>
+        void copyNodes(const Curve& curve, std::vector<double>& times, std::vector<double>& logDiscounts) {
+            times = curve.times();
+            logDiscounts.reserve(times.size());
+            for (double df : curve.data()) logDiscounts.push_back(std::log(df));
+        }
+
+        // the log discount of a flat forward is linear in t only for these compoundings
+        bool hasLogLinearCompounding(const FlatForward& curve) {
+            return curve.compounding() == Continuous || curve.compounding() == Compounded;
+        }
+
+        /*
+         * Node times of the interpolated curves CurveBuilder::restore builds for saved piecewise curves (the
+         * curves of BootstrappedCurve::nodeCopy), which nothing changes once built; false for other curves.
+         */
+        bool interpolatedNodes(const boost::shared_ptr<YieldTermStructure>& curve, std::vector<double>* times = nullptr) {
+            bool found = false;
+            for (const auto& traits : configNames(PiecewiseTraits())) {
+                for (const auto& interpolation : configNames(PiecewiseInterpolators())) {
+                    dispatchByName(PiecewiseTraits(), traits, [&](auto traitsTag) {
+                        dispatchByName(PiecewiseInterpolators(), interpolation, [&](auto interpolatorTag) {
+                            using Interpolator = typename decltype(interpolatorTag)::type;
+                            using Copy         = typename decltype(traitsTag)::type::template curve<Interpolator>::type;
+                            auto copy          = boost::dynamic_pointer_cast<Copy>(curve);
+                            if (!copy) return;
+                            if (times) *times = copy->times();
+                            found = true;
+                        });
+                    });
+                }
+            }
+            return found;
+        }
+
+        // null for curves that cannot be compiled
+        std::shared_ptr<const CompiledCurve> compile(const MarketStore& marketStore, CurveId id) {
+            const BootstrappedCurve& piecewise = marketStore.getBootstrappedCurve(id);
+            if (piecewise) return std::make_shared<const CompiledCurve>(piecewise);
+            auto curve = marketStore.getCurve(id);
+            return CompiledCurve::isSupported(curve) ? std::make_shared<const CompiledCurve>(curve) : nullptr;
+        }
+    }  // namespace
+
+    CompiledCurve::CompiledCurve(const boost::shared_ptr<YieldTermStructure>& curve)
+    : referenceDate_(curve->referenceDate()), dayCounter_(curve->dayCounter()) {
+        copyRange(*curve);
+        if (auto discount = boost::dynamic_pointer_cast<DiscountCurve>(curve)) {
+            copyNodes(*discount, times_, logDiscounts_);
+        }
+        else if (auto flat = boost::dynamic_pointer_cast<FlatForward>(curve)) {
+            // two nodes at the equivalent continuous rate, exact only when the log discount is linear in t
+            Rate rate     = flat->zeroRate(1.0, Continuous, NoFrequency, true).rate();
+            times_        = {0.0, 1.0};
+            logDiscounts_ = {0.0, -rate};
+            if (!hasLogLinearCompounding(*flat)) {
+                Compounding comp = flat->compounding();
+                Frequency freq   = flat->compoundingFrequency();
+                Rate flatRate    = flat->zeroRate(1.0, comp, freq, true).rate();
+                frozen_.reset(new FlatForward(referenceDate_, flatRate, dayCounter_, comp, freq));
+                // flat forwards compute their rate lazily, so this is done here and not by concurrent readers
+                frozen_->discount(1.0, true);
+            }
+        }
+        else if (interpolatedNodes(curve, &times_)) {
+            for (Time t : times_) logDiscounts_.push_back(std::log(curve->discount(t, true)));
+            frozen_ = curve;
+        }
+        else {
+            throw std::runtime_error("Curve type not supported by CompiledCurve");
+        }
+        computeSlopes();
+    }
+
+    CompiledCurve::CompiledCurve(const BootstrappedCurve& curve)
+    : referenceDate_(curve.termStructure()->referenceDate()), dayCounter_(curve.termStructure()->dayCounter()) {
+        if (!isSupported(curve)) throw std::runtime_error("Curve type not supported by CompiledCurve");
+        copyRange(*curve.termStructure());
+        if (curve.isLogLinearDiscount()) {
+            copyNodes(curve, times_, logDiscounts_);
+        }
+        else {
+            times_ = curve.times();
+            for (double df : curve.nodeDiscounts()) logDiscounts_.push_back(std::log(df));
+            frozen_ = curve.nodeCopy();
+        }
+        computeSlopes();
+    }
+
+    void CompiledCurve::copyRange(const YieldTermStructure& curve) {
+        allowsExtrapolation_ = curve.allowsExtrapolation();
+        maxTime_             = curve.maxTime();
+    }
+
+    void CompiledCurve::computeSlopes() {
+        if (times_.size() < 2 || times_.size() != logDiscounts_.size())
+            throw std::runtime_error("A compiled curve needs at least two nodes and one log discount per node");
+        slopes_.resize(times_.size() - 1);
+        for (size_t i = 0; i < slopes_.size(); ++i) slopes_[i] = (logDiscounts_[i + 1] - logDiscounts_[i]) / (times_[i + 1] - times_[i]);
+    }
+
+    bool CompiledCurve::isSupported(const boost::shared_ptr<YieldTermStructure>& curve) {
+        return boost::dynamic_pointer_cast<DiscountCurve>(curve) || boost::dynamic_pointer_cast<FlatForward>(curve) || interpolatedNodes(curve);
+    }
+
+    bool CompiledCurve::isSupported(const BootstrappedCurve& curve) {
+        return static_cast<bool>(curve);
+    }
+
+    bool CompiledCurve::isLogLinear(const boost::shared_ptr<YieldTermStructure>& curve) {
+        if (boost::dynamic_pointer_cast<DiscountCurve>(curve)) return true;
+        auto flat = boost::dynamic_pointer_cast<FlatForward>(curve);
+        return flat && hasLogLinearCompounding(*flat);
+    }
+
+    void CompiledCurve::discounts(const Time* times, size_t n, double* out) const {
+        for (size_t i = 0; i < n; ++i) out[i] = discount(times[i]);
+    }
+
+    void CompiledCurve::discounts(const Date::serial_type* dates, size_t n, double* out) const {
+        for (size_t i = 0; i < n; ++i) out[i] = discount(timeFromReference(Date(dates[i])));
+    }
+
+    CurveSnapshot::CurveSnapshot(const MarketStore& marketStore, uint64_t epoch) : epoch_(epoch) {
+        curves_.resize(marketStore.curveIdCount());
+        for (CurveId id = 0; id < curves_.size(); ++id) {
+            if (!marketStore.hasCurve(id)) continue;
+            if (auto compiled = compile(marketStore, id)) addCurve(id, marketStore.curveName(id), std::move(compiled));
+        }
+    }
+
+    CurveSnapshot::CurveSnapshot(const MarketStore& marketStore, const CurveSnapshot& previous, const std::vector<std::string>& changedCurves)
+    : epoch_(previous.epoch() + 1) {
+        std::unordered_set<CurveId> changed;
+        for (const auto& name : changedCurves) changed.insert(marketStore.curveId(name));
+        curves_.resize(marketStore.curveIdCount());
+        for (CurveId id = 0; id < curves_.size(); ++id) {
+            if (!marketStore.hasCurve(id)) continue;
+            if (previous.hasCurve(id) && changed.find(id) == changed.end()) {
+                addCurve(id, marketStore.curveName(id), previous.curves_[id]);
+                continue;
+            }
+            if (auto compiled = compile(marketStore, id)) addCurve(id, marketStore.curveName(id), std::move(compiled));
+        }
+    }
+
+    void CurveSnapshot::addCurve(CurveId id, const std::string& name, std::shared_ptr<const CompiledCurve> curve) {
+        ids_[name] = id;
+        names_.push_back(name);
+        curves_[id] = std::move(curve);
+    }
+
+    bool CurveSnapshot::hasCurve(const std::string& name) const {
+        return ids_.find(name) != ids_.end();
+    }
+
+    CurveId CurveSnapshot::curveId(const std::string& name) const {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) throw std::runtime_error("Curve not found in snapshot: " + name);
+        return it->second;
+    }
+
+    const CompiledCurve& CurveSnapshot::curve(const std::string& name) const {
+        return *curves_[curveId(name)];
+    }
+
+    std::vector<std::string> CurveSnapshot::allCurves() const {
+        return names_;
+    }
+}  // namespace CurveManager
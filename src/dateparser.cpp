@@ -0,0 +1,76 @@
+#include <curvemanager/dateparser.hpp>
+#include <qlp/parser.hpp>
+#include <unordered_map>
+
+namespace CurveManager
+{
+    namespace
+    {
+        inline int digits(const char* data, size_t n) {
+            int value = 0;
+            for (size_t i = 0; i < n; ++i) {
+                unsigned digit = static_cast<unsigned char>(data[i]) - '0';
+                if (digit > 9) return -1;
+                value = value * 10 + static_cast<int>(digit);
+            }
+            return value;
+        }
+
+        template <typename Key, typename Value>
+        void insertBounded(std::unordered_map<Key, Value>& cache, const Key& key, const Value& value) {
+            if (cache.size() >= dateCacheSize) cache.clear();
+            cache.emplace(key, value);
+        }
+    }  // namespace
+
+    bool parseDDMMYYYY(const char* data, size_t size, Date& date) {
+        if (size != 8) return false;
+        int day = digits(data, 2), month = digits(data + 2, 2), year = digits(data + 4, 4);
+        if (day < 1 || month < 1 || month > 12 || year < 1901 || year > 2199) return false;
+        static const int monthLength[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        if (day > monthLength[month - 1] + (month == 2 && Date::isLeap(year) ? 1 : 0)) return false;
+        date = Date(day, static_cast<Month>(month), year);
+        return true;
+    }
+
+    std::string formatDDMMYYYY(const Date& date) {
+        std::string result(8, '0');
+        writeDDMMYYYY(date, result.data());
+        return result;
+    }
+
+    void writeDDMMYYYY(const Date& date, char* out) {
+        int day = date.dayOfMonth(), month = static_cast<int>(date.month()), year = date.year();
+        out[0] = static_cast<char>('0' + day / 10);
+        out[1] = static_cast<char>('0' + day % 10);
+        out[2] = static_cast<char>('0' + month / 10);
+        out[3] = static_cast<char>('0' + month % 10);
+        for (int i = 7; i >= 4; --i, year /= 10) out[i] = static_cast<char>('0' + year % 10);
+    }
+
+    Date cachedParseDate(const std::string& date) {
+        Date result;
+        if (parseDDMMYYYY(date.data(), date.size(), result)) return result;
+
+        thread_local std::unordered_map<std::string, Date::serial_type> cache;
+        auto it = cache.find(date);
+        if (it != cache.end()) return Date(it->second);
+        result = QuantLibParser::parse<Date>(date);
+        insertBounded(cache, date, result.serialNumber());
+        return result;
+    }
+
+    Date cachedParseDate(const json& date) {
+        if (date.is_string()) return cachedParseDate(date.get_ref<const std::string&>());
+        return QuantLibParser::parse<Date>(date);
+    }
+
+    std::string cachedFormatDate(const Date& date) {
+        thread_local std::unordered_map<Date::serial_type, std::string> cache;
+        auto it = cache.find(date.serialNumber());
+        if (it != cache.end()) return it->second;
+        std::string result = QuantLibParser::parseDate(date, QuantLibParser::DateFormat::MIXED);
+        insertBounded(cache, date.serialNumber(), result);
+        return result;
+    }
+}  // namespace CurveManager
@@ -0,0 +1,370 @@
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/encoding.hpp>
+#include "utils/binaryio.hpp"
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace CurveManager
+{
+    namespace
+    {
+        const uint32_t columnarQueryMagic    = 0x51434d43;  // "CMCQ"
+        const uint32_t columnarResponseMagic = 0x52434d43;  // "CMCR"
+        const uint32_t columnarForwardMagic  = 0x46434d43;  // "CMCF"
+
+        // CBOR and MessagePack rows have a fixed size: a two entry map, the DATE and VALUE keys, an 8 character
+        // date and a float64
+        const size_t binaryRowBytes = 1 + 5 + 9 + 6 + 9;
+        // longest JSON row: {"DATE":"DDMMYYYY","VALUE":<24 characters at most>},
+        const size_t jsonRowBytes = 27 + 24 + 2;
+
+        // forward documents: a ["DDMMYYYY","DDMMYYYY"] pair and a value, each with its comma; in CBOR and
+        // MessagePack a two element array of 8 character dates and a float64
+        const size_t jsonPairBytes    = 23 + 1;
+        const size_t jsonValueBytes   = 24 + 1;
+        const size_t binaryPairBytes  = 1 + 2 * 9;
+        const size_t binaryValueBytes = 9;
+
+        void checkLittleEndian() {
+            if constexpr (std::endian::native != std::endian::little) throw std::runtime_error("The columnar encoding requires a little endian host");
+        }
+
+        template <typename T>
+        uint8_t* putLittle(uint8_t* out, T value) {
+            std::memcpy(out, &value, sizeof(T));
+            return out + sizeof(T);
+        }
+
+        uint8_t* putBig(uint8_t* out, uint64_t value, size_t bytes) {
+            for (size_t i = 0; i < bytes; ++i) out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+            return out + bytes;
+        }
+
+        uint8_t* putText(uint8_t* out, const char* text, size_t n) {
+            std::memcpy(out, text, n);
+            return out + n;
+        }
+
+        // CBOR head of a major type with its argument, in the shortest form
+        uint8_t* putCBORHead(uint8_t* out, uint8_t major, uint64_t argument) {
+            if (argument < 24) {
+                *out++ = static_cast<uint8_t>(major << 5 | argument);
+                return out;
+            }
+            size_t bytes = argument <= 0xff ? 1 : argument <= 0xffff ? 2 : argument <= 0xffffffff ? 4 : 8;
+            *out++       = static_cast<uint8_t>(major << 5 | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+            return putBig(out, argument, bytes);
+        }
+
+        uint8_t* putMessagePackArray(uint8_t* out, size_t n) {
+            if (n < 16) {
+                *out++ = static_cast<uint8_t>(0x90 | n);
+                return out;
+            }
+            if (n <= 0xffff) return putBig(putText(out, "\xdc", 1), n, 2);
+            return putBig(putText(out, "\xdd", 1), n, 4);
+        }
+
+        // shortest representation that reads back to the same double; like nlohmann, non finite values are null
+        char* putJSONNumber(char* out, double value) {
+            if (std::isfinite(value)) return std::to_chars(out, out + 24, value).ptr;
+            return static_cast<char*>(std::memcpy(out, "null", 4)) + 4;
+        }
+
+        void appendString(std::vector<uint8_t>& out, const std::string& value) {
+            uint32_t size = static_cast<uint32_t>(value.size());
+            out.resize(out.size() + sizeof(size) + value.size());
+            uint8_t* p = out.data() + out.size() - sizeof(size) - value.size();
+            putText(putLittle(p, size), value.data(), value.size());
+        }
+    }  // namespace
+
+    Encoding parseEncoding(const std::string& name) {
+        if (name == "JSON") return Encoding::JSON;
+        if (name == "CBOR") return Encoding::CBOR;
+        if (name == "MSGPACK") return Encoding::MessagePack;
+        if (name == "COLUMNAR") return Encoding::Columnar;
+        throw std::runtime_error("Unknown encoding " + name + " (expected JSON, CBOR, MSGPACK or COLUMNAR)");
+    }
+
+    std::vector<uint8_t> encodeDocument(const json& document, Encoding encoding) {
+        switch (encoding) {
+            case Encoding::JSON: {
+                std::string text = document.dump();
+                return std::vector<uint8_t>(text.begin(), text.end());
+            }
+            case Encoding::CBOR:
+                return json::to_cbor(document);
+            case Encoding::MessagePack:
+                return json::to_msgpack(document);
+            default:
+                throw std::runtime_error("The columnar encoding only holds queries and responses, not JSON documents");
+        }
+    }
+
+    json decodeDocument(const uint8_t* data, size_t size, Encoding encoding) {
+        switch (encoding) {
+            case Encoding::JSON:
+                return json::parse(data, data + size);
+            case Encoding::CBOR:
+                return json::from_cbor(data, data + size);
+            case Encoding::MessagePack:
+                return json::from_msgpack(data, data + size);
+            default:
+                throw std::runtime_error("The columnar encoding only holds queries and responses, not JSON documents");
+        }
+    }
+
+    std::vector<uint8_t> encodeColumnarQuery(const ColumnarQuery& query) {
+        checkLittleEndian();
+        std::vector<uint8_t> out(sizeof(uint32_t));
+        putLittle(out.data(), columnarQueryMagic);
+        for (const auto* field : {&query.curve, &query.dayCounter, &query.compounding, &query.frequency}) appendString(out, *field);
+
+        size_t offset = out.size();
+        out.resize(offset + sizeof(uint32_t) + query.dates.size() * sizeof(int32_t));
+        uint8_t* p = putLittle(out.data() + offset, static_cast<uint32_t>(query.dates.size()));
+        for (auto date : query.dates) p = putLittle(p, static_cast<int32_t>(date));
+        if (query.endDates.empty()) return out;
+
+        if (query.endDates.size() != query.dates.size()) throw std::runtime_error("A forward query needs one end date per start date");
+        offset = out.size();
+        out.resize(offset + sizeof(uint32_t) + query.endDates.size() * sizeof(int32_t));
+        p = putLittle(out.data() + offset, static_cast<uint32_t>(query.endDates.size()));
+        for (auto date : query.endDates) p = putLittle(p, static_cast<int32_t>(date));
+        return out;
+    }
+
+    ColumnarQuery decodeColumnarQuery(const uint8_t* data, size_t size) {
+        utils::BinaryReader reader(reinterpret_cast<const char*>(data), size);
+        if (reader.read<uint32_t>() != columnarQueryMagic) throw std::runtime_error("Not a columnar query");
+        ColumnarQuery query;
+        query.curve       = reader.readString();
+        query.dayCounter  = reader.readString();
+        query.compounding = reader.readString();
+        query.frequency   = reader.readString();
+
+        uint32_t n = reader.read<uint32_t>();
+        query.dates.reserve(n);
+        for (uint32_t i = 0; i < n; ++i) query.dates.push_back(reader.read<int32_t>());
+        if (!reader.atEnd()) {
+            if (reader.read<uint32_t>() != n) throw std::runtime_error("Corrupt columnar query: the end dates do not match the start dates");
+            query.endDates.reserve(n);
+            for (uint32_t i = 0; i < n; ++i) query.endDates.push_back(reader.read<int32_t>());
+        }
+        if (!reader.atEnd()) throw std::runtime_error("Corrupt columnar query: trailing bytes");
+        return query;
+    }
+
+    void decodeColumnarResponse(const uint8_t* data, size_t size, std::vector<Date::serial_type>& dates, std::vector<double>& values) {
+        utils::BinaryReader reader(reinterpret_cast<const char*>(data), size);
+        if (reader.read<uint32_t>() != columnarResponseMagic) throw std::runtime_error("Not a columnar response");
+        uint32_t n = reader.read<uint32_t>();
+        if (size != 2 * sizeof(uint32_t) + n * (sizeof(double) + sizeof(int32_t))) throw std::runtime_error("Corrupt columnar response");
+
+        values.resize(n);
+        if (n > 0) std::memcpy(values.data(), data + 2 * sizeof(uint32_t), n * sizeof(double));
+        const uint8_t* serials = data + 2 * sizeof(uint32_t) + n * sizeof(double);
+        dates.resize(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            int32_t serial;
+            std::memcpy(&serial, serials + i * sizeof(int32_t), sizeof(serial));
+            dates[i] = serial;
+        }
+    }
+
+    void decodeColumnarForwardResponse(const uint8_t* data,
+                                       size_t size,
+                                       std::vector<Date::serial_type>& startDates,
+                                       std::vector<Date::serial_type>& endDates,
+                                       std::vector<double>& values) {
+        utils::BinaryReader reader(reinterpret_cast<const char*>(data), size);
+        if (reader.read<uint32_t>() != columnarForwardMagic) throw std::runtime_error("Not a columnar forward response");
+        uint32_t n = reader.read<uint32_t>();
+        if (size != 2 * sizeof(uint32_t) + n * (sizeof(double) + 2 * sizeof(int32_t))) throw std::runtime_error("Corrupt columnar forward response");
+
+        values.resize(n);
+        if (n > 0) std::memcpy(values.data(), data + 2 * sizeof(uint32_t), n * sizeof(double));
+        const uint8_t* serials = data + 2 * sizeof(uint32_t) + n * sizeof(double);
+        for (auto* dates : {&startDates, &endDates}) {
+            dates->resize(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                int32_t serial;
+                std::memcpy(&serial, serials + i * sizeof(int32_t), sizeof(serial));
+                (*dates)[i] = serial;
+            }
+            serials += n * sizeof(int32_t);
+        }
+    }
+
+    const std::vector<uint8_t>& ResponseEncoder::encode(const Date::serial_type* dates, const double* values, size_t n) {
+        switch (encoding_) {
+            case Encoding::JSON:
+                encodeJSON(dates, values, n);
+                break;
+            case Encoding::CBOR:
+                encodeCBOR(dates, values, n);
+                break;
+            case Encoding::MessagePack:
+                encodeMessagePack(dates, values, n);
+                break;
+            case Encoding::Columnar:
+                encodeColumnar(dates, values, n);
+                break;
+        }
+        return buffer_;
+    }
+
+    const std::vector<uint8_t>& ResponseEncoder::encode(const Date::serial_type* startDates,
+                                                        const Date::serial_type* endDates,
+                                                        const double* values,
+                                                        size_t n) {
+        switch (encoding_) {
+            case Encoding::JSON:
+                encodeForwardJSON(startDates, endDates, values, n);
+                break;
+            case Encoding::CBOR:
+                encodeForwardCBOR(startDates, endDates, values, n);
+                break;
+            case Encoding::MessagePack:
+                encodeForwardMessagePack(startDates, endDates, values, n);
+                break;
+            case Encoding::Columnar:
+                encodeForwardColumnar(startDates, endDates, values, n);
+                break;
+        }
+        return buffer_;
+    }
+
+    void ResponseEncoder::encodeJSON(const Date::serial_type* dates, const double* values, size_t n) {
+        // sized for the longest rows, then trimmed; the capacity stays for the next call
+        buffer_.resize(2 + n * jsonRowBytes);
+        char* begin = reinterpret_cast<char*>(buffer_.data());
+        char* p     = begin;
+        *p++        = '[';
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0) *p++ = ',';
+            std::memcpy(p, "{\"DATE\":\"", 9);
+            writeDDMMYYYY(Date(dates[i]), p + 9);
+            std::memcpy(p + 17, "\",\"VALUE\":", 10);
+            p    = putJSONNumber(p + 27, values[i]);
+            *p++ = '}';
+        }
+        *p++ = ']';
+        buffer_.resize(static_cast<size_t>(p - begin));
+    }
+
+    void ResponseEncoder::encodeCBOR(const Date::serial_type* dates, const double* values, size_t n) {
+        buffer_.resize(9 + n * binaryRowBytes);
+        uint8_t* p = putCBORHead(buffer_.data(), 4, n);
+        for (size_t i = 0; i < n; ++i) {
+            *p++ = 0xa2;  // map of 2
+            p    = putText(p, "\x64" "DATE" "\x68", 6);
+            writeDDMMYYYY(Date(dates[i]), reinterpret_cast<char*>(p));
+            p = putText(p + 8, "\x65" "VALUE" "\xfb", 7);
+            p = putBig(p, std::bit_cast<uint64_t>(values[i]), 8);
+        }
+        buffer_.resize(static_cast<size_t>(p - buffer_.data()));
+    }
+
+    void ResponseEncoder::encodeMessagePack(const Date::serial_type* dates, const double* values, size_t n) {
+        buffer_.resize(5 + n * binaryRowBytes);
+        uint8_t* p = putMessagePackArray(buffer_.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            *p++ = 0x82;  // map of 2
+            p    = putText(p, "\xa4" "DATE" "\xa8", 6);
+            writeDDMMYYYY(Date(dates[i]), reinterpret_cast<char*>(p));
+            p = putText(p + 8, "\xa5" "VALUE" "\xcb", 7);
+            p = putBig(p, std::bit_cast<uint64_t>(values[i]), 8);
+        }
+        buffer_.resize(static_cast<size_t>(p - buffer_.data()));
+    }
+
+    void ResponseEncoder::encodeColumnar(const Date::serial_type* dates, const double* values, size_t n) {
+        checkLittleEndian();
+        buffer_.resize(2 * sizeof(uint32_t) + n * (sizeof(double) + sizeof(int32_t)));
+        uint8_t* p = putLittle(buffer_.data(), columnarResponseMagic);
+        p          = putLittle(p, static_cast<uint32_t>(n));
+        if (n > 0) std::memcpy(p, values, n * sizeof(double));
+        p += n * sizeof(double);
+        for (size_t i = 0; i < n; ++i) p = putLittle(p, static_cast<int32_t>(dates[i]));
+    }
+
+    void ResponseEncoder::encodeForwardJSON(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n) {
+        // keys in the order nlohmann dumps them
+        buffer_.resize(24 + n * (jsonPairBytes + jsonValueBytes));
+        char* begin = reinterpret_cast<char*>(buffer_.data());
+        char* p     = static_cast<char*>(std::memcpy(begin, "{\"DATES\":[", 10)) + 10;
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0) *p++ = ',';
+            std::memcpy(p, "[\"", 2);
+            writeDDMMYYYY(Date(startDates[i]), p + 2);
+            std::memcpy(p + 10, "\",\"", 3);
+            writeDDMMYYYY(Date(endDates[i]), p + 13);
+            std::memcpy(p + 21, "\"]", 2);
+            p += 23;
+        }
+        p = static_cast<char*>(std::memcpy(p, "],\"VALUES\":[", 12)) + 12;
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0) *p++ = ',';
+            p = putJSONNumber(p, values[i]);
+        }
+        *p++ = ']';
+        *p++ = '}';
+        buffer_.resize(static_cast<size_t>(p - begin));
+    }
+
+    void ResponseEncoder::encodeForwardCBOR(const Date::serial_type* startDates, const Date::serial_type* endDates, const double* values, size_t n) {
+        buffer_.resize(1 + 6 + 9 + 7 + 9 + n * (binaryPairBytes + binaryValueBytes));
+        uint8_t* p = buffer_.data();
+        *p++       = 0xa2;  // map of 2
+        p          = putCBORHead(putText(p, "\x65" "DATES", 6), 4, n);
+        for (size_t i = 0; i < n; ++i) {
+            p = putText(p, "\x82" "\x68", 2);
+            writeDDMMYYYY(Date(startDates[i]), reinterpret_cast<char*>(p));
+            p = putText(p + 8, "\x68", 1);
+            writeDDMMYYYY(Date(endDates[i]), reinterpret_cast<char*>(p));
+            p += 8;
+        }
+        p = putCBORHead(putText(p, "\x66" "VALUES", 7), 4, n);
+        for (size_t i = 0; i < n; ++i) p = putBig(putText(p, "\xfb", 1), std::bit_cast<uint64_t>(values[i]), 8);
+        buffer_.resize(static_cast<size_t>(p - buffer_.data()));
+    }
+
+    void ResponseEncoder::encodeForwardMessagePack(const Date::serial_type* startDates,
+                                                   const Date::serial_type* endDates,
+                                                   const double* values,
+                                                   size_t n) {
+        buffer_.resize(1 + 6 + 5 + 7 + 5 + n * (binaryPairBytes + binaryValueBytes));
+        uint8_t* p = buffer_.data();
+        *p++       = 0x82;  // map of 2
+        p          = putMessagePackArray(putText(p, "\xa5" "DATES", 6), n);
+        for (size_t i = 0; i < n; ++i) {
+            p = putText(p, "\x92" "\xa8", 2);
+            writeDDMMYYYY(Date(startDates[i]), reinterpret_cast<char*>(p));
+            p = putText(p + 8, "\xa8", 1);
+            writeDDMMYYYY(Date(endDates[i]), reinterpret_cast<char*>(p));
+            p += 8;
+        }
+        p = putMessagePackArray(putText(p, "\xa6" "VALUES", 7), n);
+        for (size_t i = 0; i < n; ++i) p = putBig(putText(p, "\xcb", 1), std::bit_cast<uint64_t>(values[i]), 8);
+        buffer_.resize(static_cast<size_t>(p - buffer_.data()));
+    }
+
+    void ResponseEncoder::encodeForwardColumnar(const Date::serial_type* startDates,
+                                                const Date::serial_type* endDates,
+                                                const double* values,
+                                                size_t n) {
+        checkLittleEndian();
+        buffer_.resize(2 * sizeof(uint32_t) + n * (sizeof(double) + 2 * sizeof(int32_t)));
+        uint8_t* p = putLittle(buffer_.data(), columnarForwardMagic);
+        p          = putLittle(p, static_cast<uint32_t>(n));
+        if (n > 0) std::memcpy(p, values, n * sizeof(double));
+        p += n * sizeof(double);
+        for (size_t i = 0; i < n; ++i) p = putLittle(p, static_cast<int32_t>(startDates[i]));
+        for (size_t i = 0; i < n; ++i) p = putLittle(p, static_cast<int32_t>(endDates[i]));
+    }
+}  // namespace CurveManager
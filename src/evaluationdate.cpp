@@ -0,0 +1,151 @@
+#include <curvemanager/evaluationdate.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(QL_ENABLE_SESSIONS) && defined(CURVEMANAGER_SESSIONS)
+#    include <functional>
+#    include <thread>
+#    include <type_traits>
+
+namespace QuantLib
+{
+    namespace
+    {
+        // ThreadKey is std::thread::id in recent QuantLib versions and an integer in older ones
+        template <typename Key>
+        Key threadKey() {
+            if constexpr (std::is_same_v<Key, std::thread::id>)
+                return std::this_thread::get_id();
+            else
+                return static_cast<Key>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        }
+    }  // namespace
+
+    // every thread is its own session
+    ThreadKey sessionId() {
+        return threadKey<ThreadKey>();
+    }
+}  // namespace QuantLib
+#elif defined(QL_ENABLE_SESSIONS)
+#    error "QuantLib was built with QL_ENABLE_SESSIONS: configure curvemanager with -DCURVEMANAGER_SESSIONS=ON"
+#endif
+
+namespace CurveManager
+{
+    namespace
+    {
+        struct DateHolders {
+            std::mutex mutex;
+            std::condition_variable released;
+            size_t sharers = 0;
+            bool exclusive = false;
+        };
+
+        DateHolders& holders() {
+            static DateHolders instance;
+            return instance;
+        }
+
+        thread_local size_t depth       = 0;
+        thread_local bool heldExclusive = false;
+        thread_local Date heldDate      = Date();
+
+        // assigning the date notifies every observer registered on it, even when the value does not change
+        void setEvaluationDate(const Date& date) {
+            if (Settings::instance().evaluationDate() != date) Settings::instance().evaluationDate() = date;
+        }
+    }  // namespace
+
+    bool hasThreadLocalSettings() {
+#if defined(QL_ENABLE_SESSIONS) && defined(CURVEMANAGER_SESSIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    EvaluationDateLock::EvaluationDateLock(const Date& date, Mode mode) : mode_(mode) {
+        acquire(date, mode, false);
+    }
+
+    EvaluationDateLock::EvaluationDateLock() : mode_(Mode::Exclusive) {
+        acquire(Date(), Mode::Exclusive, true);
+    }
+
+    EvaluationDateLock::~EvaluationDateLock() {
+        if (nested_) {
+            --depth;
+        }
+        else if (owner_) {
+            DateHolders& state = holders();
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (mode_ == Mode::Exclusive)
+                    state.exclusive = false;
+                else
+                    --state.sharers;
+            }
+            depth = 0;
+            state.released.notify_all();
+        }
+    }
+
+    EvaluationDateLock::Context EvaluationDateLock::capture(const Date& date) {
+        static std::atomic<uint64_t> contexts = 0;
+        Context context;
+        context.date = date;
+        context.id   = ++contexts;
+        if (hasThreadLocalSettings()) {
+            IndexManager& manager = IndexManager::instance();
+            for (const auto& name : manager.histories()) context.fixings.emplace_back(name, manager.getHistory(name));
+        }
+        return context;
+    }
+
+    void EvaluationDateLock::inherit(const Context& context) {
+        if (!hasThreadLocalSettings()) return;
+        setEvaluationDate(context.date);
+        // a pool thread runs many tasks of the same holder, and only copies the fixings for the first one
+        thread_local uint64_t inherited = 0;
+        if (inherited == context.id) return;
+        IndexManager& manager = IndexManager::instance();
+        for (const auto& [name, history] : context.fixings) manager.setHistory(name, history);
+        inherited = context.id;
+    }
+
+    void EvaluationDateLock::acquire(const Date& date, Mode mode, bool keepDate) {
+        if (hasThreadLocalSettings()) {
+            if (!keepDate) setEvaluationDate(date);
+            return;
+        }
+        if (depth > 0) {
+            if (!keepDate && date != heldDate) throw std::runtime_error("The evaluation date is held for another date on this thread");
+            // this includes the default hold, which would otherwise destroy QuantLib objects under the sharers
+            if (mode == Mode::Exclusive && !heldExclusive)
+                throw std::runtime_error("A shared hold of the evaluation date cannot be made exclusive");
+            ++depth;
+            nested_ = true;
+            return;
+        }
+
+        DateHolders& state = holders();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (mode == Mode::Exclusive) {
+            state.released.wait(lock, [&]() { return !state.exclusive && state.sharers == 0; });
+            state.exclusive = true;
+        }
+        else {
+            state.released.wait(lock, [&]() { return !state.exclusive && (state.sharers == 0 || Settings::instance().evaluationDate() == date); });
+            ++state.sharers;
+        }
+        // other holders, if any, share this date, so they only see the value they expect
+        if (!keepDate) setEvaluationDate(date);
+        heldDate      = Settings::instance().evaluationDate();
+        heldExclusive = mode == Mode::Exclusive;
+        depth         = 1;
+        owner_        = true;
+    }
+}  // namespace CurveManager
@@ -0,0 +1,142 @@
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/fixings.hpp>
+#include "utils/binaryio.hpp"
+#include "utils/mappedfile.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace CurveManager
+{
+    namespace
+    {
+        const uint64_t fixingsMagic = 0x474e495849464d43;  // "CMFIXING"
+        const uint32_t fileVersion  = 1;
+
+        bool isBinary(const char* data, size_t size) {
+            uint64_t magic = 0;
+            if (size < sizeof(magic)) return false;
+            std::memcpy(&magic, data, sizeof(magic));
+            return magic == fixingsMagic;
+        }
+
+        // next line of [begin, end), without its line break; begin is moved past it
+        std::string_view nextLine(const char*& begin, const char* end) {
+            if (begin == end) return std::string_view();
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (!lineEnd) lineEnd = end;
+            std::string_view line(begin, lineEnd - begin);
+            begin = lineEnd == end ? end : lineEnd + 1;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            return line;
+        }
+
+        // next comma separated cell of line, which is left with the rest
+        std::string_view nextCell(std::string_view& line) {
+            size_t comma          = line.find(',');
+            std::string_view cell = line.substr(0, comma);
+            line                  = comma == std::string_view::npos ? std::string_view() : line.substr(comma + 1);
+            return cell;
+        }
+
+        FixingsTable parseCSV(const char* data, size_t size, const std::string& path) {
+            const char* begin = data;
+            const char* end   = data + size;
+            FixingsTable fixings;
+
+            // columns point into the table: references to unordered_map elements survive rehashing
+            std::string_view header = nextLine(begin, end);
+            if (nextCell(header) != "DATE") throw std::runtime_error("Expected a DATE,<INDEX>,... header in " + path);
+            std::vector<FixingSeries*> columns;
+            while (!header.empty()) {
+                std::string name(nextCell(header));
+                if (name.empty()) throw std::runtime_error("Empty index name in the header of " + path);
+                if (fixings.find(name) != fixings.end()) throw std::runtime_error("Index " + name + " repeated in the header of " + path);
+                columns.push_back(&fixings[name]);
+            }
+            if (columns.empty()) throw std::runtime_error("Expected a DATE,<INDEX>,... header in " + path);
+
+            size_t rows = static_cast<size_t>(std::count(begin, end, '\n')) + 1;
+            for (auto* column : columns) {
+                column->dates.reserve(rows);
+                column->values.reserve(rows);
+            }
+
+            for (size_t lineNumber = 2; begin != end; ++lineNumber) {
+                std::string_view line = nextLine(begin, end);
+                if (line.empty()) continue;
+
+                std::string_view dateCell = nextCell(line);
+                Date date;
+                if (!parseDDMMYYYY(dateCell.data(), dateCell.size(), date))
+                    throw std::runtime_error("Invalid date (expected DDMMYYYY) at " + path + ":" + std::to_string(lineNumber));
+                for (auto* column : columns) {
+                    std::string_view cell = nextCell(line);
+                    if (cell.empty()) continue;
+                    double value = 0.0;
+                    auto result  = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+                    if (result.ec != std::errc() || result.ptr != cell.data() + cell.size())
+                        throw std::runtime_error("Invalid value at " + path + ":" + std::to_string(lineNumber));
+                    column->dates.push_back(date);
+                    column->values.push_back(value);
+                }
+                if (!line.empty()) throw std::runtime_error("More cells than indexes at " + path + ":" + std::to_string(lineNumber));
+            }
+            return fixings;
+        }
+
+        FixingsTable parseBinary(const char* data, size_t size, const std::string& path) {
+            utils::BinaryReader reader(data, size);
+            if (reader.read<uint64_t>() != fixingsMagic) throw std::runtime_error("Not a fixings file: " + path);
+            if (reader.read<uint32_t>() != fileVersion) throw std::runtime_error("Unsupported fixings file version: " + path);
+
+            FixingsTable fixings;
+            uint32_t nIndexes = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < nIndexes; ++i) {
+                std::string name                       = reader.readString();
+                std::vector<Date::serial_type> serials = reader.readArray<Date::serial_type>();
+                FixingSeries& series                   = fixings[name];
+                series.values                          = reader.readArray<double>();
+                if (serials.size() != series.values.size()) throw std::runtime_error("Corrupt fixings file: " + path);
+                series.dates.reserve(serials.size());
+                for (auto serial : serials) series.dates.push_back(Date(serial));
+            }
+            return fixings;
+        }
+    }  // namespace
+
+    FixingsTable readFixings(const std::string& path) {
+        utils::MappedFile file(path);
+        if (isBinary(file.data(), file.size())) return parseBinary(file.data(), file.size(), path);
+        return parseCSV(file.data(), file.size(), path);
+    }
+
+    FixingsTable readFixingsCSV(const std::string& path) {
+        utils::MappedFile file(path);
+        return parseCSV(file.data(), file.size(), path);
+    }
+
+    FixingsTable readFixingsBinary(const std::string& path) {
+        utils::MappedFile file(path);
+        return parseBinary(file.data(), file.size(), path);
+    }
+
+    void writeFixingsBinary(const std::string& path, const FixingsTable& fixings) {
+        utils::BinaryWriter writer(path);
+        writer.write<uint64_t>(fixingsMagic);
+        writer.write<uint32_t>(fileVersion);
+        writer.write<uint32_t>(static_cast<uint32_t>(fixings.size()));
+        for (const auto& [name, series] : fixings) {
+            if (series.dates.size() != series.values.size()) throw std::runtime_error("Dates and values of the fixings of " + name + " do not match");
+            std::vector<Date::serial_type> serials;
+            serials.reserve(series.dates.size());
+            for (const auto& date : series.dates) serials.push_back(date.serialNumber());
+            writer.writeString(name);
+            writer.writeArray(serials);
+            writer.writeArray(series.values);
+        }
+        writer.close();
+    }
+}  // namespace CurveManager
@@ -0,0 +1,276 @@
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/historyengine.hpp>
+#include <curvemanager/schemaregistry.hpp>
+#include <curvemanager/schemas/all.hpp>
+#include "utils/binaryio.hpp"
+#include "utils/mappedfile.hpp"
+#include "utils/threadpool.hpp"
+#include <cstdlib>
+#include <fstream>
+
+namespace CurveManager
+{
+    using namespace QuantLibParser;
+
+    namespace
+    {
+        const uint64_t historyMagic = 0x5952545349484d43;  // "CMHISTRY"
+        const uint64_t nodesMagic   = 0x5345444f4e484d43;  // "CMHNODES"
+        const uint32_t fileVersion  = 1;
+
+        // calls onRow(date, name, value) for each DATE,NAME,VALUE row; a first row without a valid date is a header
+        template <typename F>
+        void readCSV(const std::string& path, F&& onRow) {
+            std::ifstream file(path);
+            if (!file) throw std::runtime_error("Could not open file: " + path);
+            std::string line;
+            size_t lineNumber = 0;
+            while (std::getline(file, line)) {
+                ++lineNumber;
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty()) continue;
+
+                std::string where = path + ":" + std::to_string(lineNumber);
+                size_t first      = line.find(',');
+                size_t last       = line.rfind(',');
+                if (first == std::string::npos || first == last) throw std::runtime_error("Expected DATE,NAME,VALUE at " + where);
+                Date date;
+                if (!parseDDMMYYYY(line.data(), first, date)) {
+                    if (lineNumber == 1) continue;
+                    throw std::runtime_error("Invalid date (expected DDMMYYYY) at " + where);
+                }
+                const char* begin = line.c_str() + last + 1;
+                char* end         = nullptr;
+                double value      = std::strtod(begin, &end);
+                if (end == begin || *end != '\0') throw std::runtime_error("Invalid value at " + where);
+                onRow(date, line.substr(first + 1, last - first - 1), value);
+            }
+        }
+
+        std::vector<Date> toDates(const std::vector<int64_t>& serials) {
+            std::vector<Date> dates;
+            dates.reserve(serials.size());
+            for (auto serial : serials) dates.push_back(Date(static_cast<Date::serial_type>(serial)));
+            return dates;
+        }
+    }  // namespace
+
+    MarketHistory MarketHistory::fromCSV(const std::string& quotesPath, const std::string& fixingsPath) {
+        MarketHistory history;
+        readCSV(quotesPath, [&](const Date& date, std::string&& ticker, double value) { history.quotes[date][std::move(ticker)] = value; });
+        if (!fixingsPath.empty())
+            readCSV(fixingsPath, [&](const Date& date, std::string&& index, double value) { history.fixings[std::move(index)][date] = value; });
+        return history;
+    }
+
+    MarketHistory MarketHistory::fromBinary(const std::string& path) {
+        utils::MappedFile file(path);
+        utils::BinaryReader reader(file.data(), file.size());
+        if (reader.read<uint64_t>() != historyMagic) throw std::runtime_error("Not a market history file: " + path);
+        if (reader.read<uint32_t>() != fileVersion) throw std::runtime_error("Unsupported market history version: " + path);
+
+        MarketHistory history;
+        std::vector<std::string> tickers(reader.read<uint32_t>());
+        for (auto& ticker : tickers) ticker = reader.readString();
+
+        uint32_t nDates = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < nDates; ++i) {
+            Date date                  = Date(static_cast<Date::serial_type>(reader.read<int64_t>()));
+            std::vector<uint32_t> ids  = reader.readArray<uint32_t>();
+            std::vector<double> values = reader.readArray<double>();
+            if (ids.size() != values.size()) throw std::runtime_error("Corrupt market history file: " + path);
+            auto& quotes = history.quotes[date];
+            for (size_t j = 0; j < ids.size(); ++j) {
+                if (ids[j] >= tickers.size()) throw std::runtime_error("Corrupt market history file: " + path);
+                quotes[tickers[ids[j]]] = values[j];
+            }
+        }
+
+        uint32_t nIndexes = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < nIndexes; ++i) {
+            std::string name           = reader.readString();
+            std::vector<Date> dates    = toDates(reader.readArray<int64_t>());
+            std::vector<double> values = reader.readArray<double>();
+            if (dates.size() != values.size()) throw std::runtime_error("Corrupt market history file: " + path);
+            auto& fixings = history.fixings[name];
+            for (size_t j = 0; j < dates.size(); ++j) fixings[dates[j]] = values[j];
+        }
+        return history;
+    }
+
+    void MarketHistory::saveBinary(const std::string& path) const {
+        std::vector<std::string> tickers;
+        std::unordered_map<std::string, uint32_t> tickerIds;
+        for (const auto& [date, values] : quotes)
+            for (const auto& [ticker, value] : values)
+                if (tickerIds.try_emplace(ticker, static_cast<uint32_t>(tickers.size())).second) tickers.push_back(ticker);
+
+        utils::BinaryWriter writer(path);
+        writer.write<uint64_t>(historyMagic);
+        writer.write<uint32_t>(fileVersion);
+        writer.write<uint32_t>(static_cast<uint32_t>(tickers.size()));
+        for (const auto& ticker : tickers) writer.writeString(ticker);
+
+        writer.write<uint32_t>(static_cast<uint32_t>(quotes.size()));
+        for (const auto& [date, values] : quotes) {
+            std::vector<uint32_t> ids;
+            std::vector<double> dayValues;
+            for (const auto& [ticker, value] : values) {
+                ids.push_back(tickerIds.at(ticker));
+                dayValues.push_back(value);
+            }
+            writer.write<int64_t>(date.serialNumber());
+            writer.writeArray(ids);
+            writer.writeArray(dayValues);
+        }
+
+        writer.write<uint32_t>(static_cast<uint32_t>(fixings.size()));
+        for (const auto& [name, series] : fixings) {
+            std::vector<int64_t> dates;
+            std::vector<double> values;
+            for (const auto& [date, value] : series) {
+                dates.push_back(date.serialNumber());
+                values.push_back(value);
+            }
+            writer.writeString(name);
+            writer.writeArray(dates);
+            writer.writeArray(values);
+        }
+        writer.close();
+    }
+
+    std::vector<Date> MarketHistory::dates() const {
+        std::vector<Date> dates;
+        dates.reserve(quotes.size());
+        for (const auto& [date, values] : quotes) dates.push_back(date);
+        return dates;
+    }
+
+    HistoryEngine::HistoryEngine(const json& config, const MarketHistory& history, size_t nThreads)
+    : config_(config), history_(history), nThreads_(nThreads) {
+        cachedSchema<CurveBuilderRequest>().validate(config_);
+    };
+
+    size_t HistoryEngine::run(const std::string& path) {
+        return run(path, history_.dates());
+    }
+
+    size_t HistoryEngine::run(const std::string& path, const std::vector<Date>& dates) {
+        static std::atomic<uint64_t> runs = 0;
+        runId_                            = ++runs;
+        fixingsLoaded_                    = false;
+        errors_.clear();
+
+        utils::BinaryWriter writer(path);
+        writer.write<uint64_t>(nodesMagic);
+        writer.write<uint32_t>(fileVersion);
+
+        size_t written = 0;
+        auto runDay    = [&](const Date& date) {
+            std::vector<CurveNodes> curves;
+            try {
+                curves = buildDay(date);
+            }
+            catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                errors_[date] = e.what();
+                return;
+            }
+            // each day is written as one block, in the order the days finish
+            std::lock_guard<std::mutex> lock(mutex_);
+            writer.write<int64_t>(date.serialNumber());
+            writer.write<uint32_t>(static_cast<uint32_t>(curves.size()));
+            for (const auto& curve : curves) {
+                writer.writeString(curve.name);
+                writer.writeArray(std::vector<int64_t>(curve.dates.begin(), curve.dates.end()));
+                writer.writeArray(curve.values);
+            }
+            ++written;
+        };
+
+        if (!hasThreadLocalSettings()) {
+            // the evaluation date lock would run the days one at a time anyway
+            for (const auto& date : dates) runDay(date);
+        }
+        else {
+            utils::ThreadPool pool(nThreads_);
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(dates.size());
+            for (const auto& date : dates) tasks.push_back(pool.submit([&, date]() { runDay(date); }));
+            utils::waitAll(tasks);
+        }
+        writer.close();
+        return written;
+    }
+
+    const std::map<Date, std::string>& HistoryEngine::errors() const {
+        return errors_;
+    }
+
+    std::vector<HistoryEngine::CurveNodes> HistoryEngine::buildDay(const Date& refDate) {
+        json config       = config_;
+        config["REFDATE"] = formatDDMMYYYY(refDate);
+
+        // the builder picks up quotes already in the store instead of creating them from the config values
+        MarketStore store;
+        store.setTrustedInput(true);
+        auto it = history_.quotes.find(refDate);
+        if (it != history_.quotes.end()) {
+            for (const auto& [ticker, value] : it->second) {
+                Handle<Quote> handle(boost::shared_ptr<Quote>(makeStoreQuote(value)));
+                store.addQuote(ticker, handle);
+            }
+        }
+
+        CurveBuilder builder(config, store);
+        loadFixings(store, refDate);
+        builder.build();
+
+        std::vector<CurveNodes> curves;
+        for (const auto& name : store.allCurves()) {
+            CurveNodes nodes{name, {}, {}};
+            if (curveNodes(store, name, nodes.dates, nodes.values)) curves.push_back(std::move(nodes));
+        }
+        return curves;
+    }
+
+    void HistoryEngine::loadFixings(MarketStore& store, const Date& refDate) {
+        // IndexManager is kept per thread with per thread Settings, and is process wide (loaded once per run) otherwise
+        thread_local uint64_t threadRun = 0;
+        bool threadLocal                = hasThreadLocalSettings();
+        if (threadLocal ? threadRun == runId_ : fixingsLoaded_.load()) return;
+
+        // adding fixings notifies the indexes of every store
+        EvaluationDateLock lock(refDate, EvaluationDateLock::Mode::Exclusive);
+        if (!threadLocal && fixingsLoaded_) return;
+        for (const auto& [name, series] : history_.fixings) {
+            if (!store.hasIndex(name) || series.empty()) continue;
+            std::vector<Date> dates;
+            std::vector<double> values;
+            for (const auto& [date, value] : series) {
+                dates.push_back(date);
+                values.push_back(value);
+            }
+            store.addFixings(name, dates, values);
+        }
+        threadRun      = runId_;
+        fixingsLoaded_ = true;
+    }
+
+    void HistoryEngine::readNodes(const std::string& path, const NodeVisitor& visitor) {
+        utils::MappedFile file(path);
+        utils::BinaryReader reader(file.data(), file.size());
+        if (reader.read<uint64_t>() != nodesMagic) throw std::runtime_error("Not a history nodes file: " + path);
+        if (reader.read<uint32_t>() != fileVersion) throw std::runtime_error("Unsupported history nodes version: " + path);
+        while (!reader.atEnd()) {
+            Date refDate     = Date(static_cast<Date::serial_type>(reader.read<int64_t>()));
+            uint32_t nCurves = reader.read<uint32_t>();
+            for (uint32_t i = 0; i < nCurves; ++i) {
+                std::string name           = reader.readString();
+                std::vector<Date> dates    = toDates(reader.readArray<int64_t>());
+                std::vector<double> values = reader.readArray<double>();
+                visitor(refDate, name, dates, values);
+            }
+        }
+    }
+}  // namespace CurveManager
@@ -0,0 +1,81 @@
+#include <curvemanager/curvemanager.hpp>
+#include <ql/termstructures/yield/discountcurve.hpp>
+
+namespace CurveManager
+{
+    void CurveBuilder::setJacobianMode(bool enabled) {
+        jacobianMode_ = enabled;
+    }
+
+    bool CurveBuilder::supportsJacobian(const std::string& name) const {
+        // the implied quotes are taken on discount curves over the nodes, which only reproduce log-linear discount curves
+        return curveHelpers_.find(name) != curveHelpers_.end() && marketStore_.getBootstrappedCurve(name).isLogLinearDiscount();
+    }
+
+    CurveBuilder::JacobianHelpers& CurveBuilder::jacobianHelpers(const std::string& name) {
+        auto it = jacobianHelpers_.find(name);
+        if (it != jacobianHelpers_.end()) return it->second;
+        JacobianHelpers& repricing = jacobianHelpers_[name];
+        try {
+            repricing.helpers = buildRateHelpers(curveConfigs_.at(name).at("RATEHELPERS"), name, &repricing.handle);
+        }
+        catch (...) {
+            jacobianHelpers_.erase(name);
+            throw;
+        }
+        return repricing;
+    }
+
+    void CurveBuilder::computeJacobian(const std::string& name) {
+        // building the helper copies registers observers on the shared quotes and on the evaluation date
+        EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+        if (!supportsJacobian(name)) throw std::runtime_error("Jacobians are only available for piecewise curves of log-linear discounts: " + name);
+        const BootstrappedCurve& curve = marketStore_.getBootstrappedCurve(name);
+        JacobianHelpers& repricing     = jacobianHelpers(name);
+        const auto& helpers            = repricing.helpers;
+        std::vector<Date> dates        = curve.dates();
+        std::vector<double> dfs        = curve.data();
+        DayCounter dayCounter          = curve.termStructure()->dayCounter();
+        const Size n                   = dates.size() - 1;  // the first node is the reference date
+        const Size m                   = helpers.size();
+        if (n != m) throw std::runtime_error("Error computing the Jacobian of " + name + ": helpers and nodes do not match");
+
+        std::unordered_map<const Quote*, std::string> quoteTickers;
+        for (const auto& ticker : marketStore_.allQuotes()) quoteTickers[marketStore_.getQuote(ticker).currentLink().get()] = ticker;
+        std::vector<std::string> tickers(m);
+        for (Size i = 0; i < m; ++i) {
+            auto ticker = quoteTickers.find(helpers[i]->quote().currentLink().get());
+            if (ticker != quoteTickers.end()) tickers[i] = ticker->second;
+        }
+
+        // the copies discount and forecast on their own handle, so relinking it only notifies them; it is
+        // relinked first since helpers take the current curve of a discounting handle in setTermStructure
+        auto impliedQuotes = [&](const std::vector<double>& values) {
+            boost::shared_ptr<YieldTermStructure> nodeCurve(new DiscountCurve(dates, values, dayCounter));
+            nodeCurve->enableExtrapolation();
+            repricing.handle.linkTo(nodeCurve);
+            for (const auto& helper : helpers) helper->setTermStructure(nodeCurve.get());
+
+            std::vector<double> quotes(m);
+            for (Size i = 0; i < m; ++i) quotes[i] = helpers[i]->impliedQuote();
+            return quotes;
+        };
+
+        // d impliedQuote_i / d df_j, j over the nodes after the reference date
+        const double bump = 1.0e-7;
+        Matrix quoteSensitivities(m, n);
+        std::vector<double> base = impliedQuotes(dfs);
+        for (Size j = 0; j < n; ++j) {
+            std::vector<double> bumped = dfs;
+            bumped[j + 1] += bump;
+            std::vector<double> quotes = impliedQuotes(bumped);
+            for (Size i = 0; i < m; ++i) quoteSensitivities[i][j] = (quotes[i] - base[i]) / bump;
+        }
+
+        CurveJacobian jacobian;
+        jacobian.dates   = std::vector<Date>(dates.begin() + 1, dates.end());
+        jacobian.tickers = tickers;
+        jacobian.values  = inverse(quoteSensitivities);
+        marketStore_.addJacobian(name, jacobian);
+    }
+}  // namespace CurveManager
@@ -1,175 +1,738 @@
 
+#include <curvemanager/curvesnapshot.hpp>
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/evaluationdate.hpp>
 #include <curvemanager/marketstore.hpp>
+#include <curvemanager/ratekernels.hpp>
+#include <curvemanager/schemaregistry.hpp>
 #include <curvemanager/schemas/all.hpp>
+#include <ql/interestrate.hpp>
 #include <qlp/parser.hpp>
 
 namespace CurveManager
 {
     using namespace QuantLibParser;
 
+    namespace
+    {
+        template <typename T>
+        void validateRequest(Schema<T>& schema, const json& request, [[maybe_unused]] MetricsRegistry& registry) {
+            CURVEMANAGER_TIME_SCOPE(registry, Timing::RequestValidation);
+            schema.validate(request);
+        }
+
+        /*
+         * A columnar query with the checks the schemas make on the JSON requests (skipped as well for trusted
+         * input): a curve, and dates QuantLib can represent. End dates are always checked, as forward requests
+         * read one per start date.
+         */
+        ColumnarQuery decodeColumnarRequest(const uint8_t* data,
+                                            size_t size,
+                                            bool forward,
+                                            bool trusted,
+                                            [[maybe_unused]] MetricsRegistry& registry) {
+            ColumnarQuery query = decodeColumnarQuery(data, size);
+            if (forward && query.endDates.size() != query.dates.size())
+                throw std::runtime_error("A forward request needs one end date per start date");
+            if (!forward && !query.endDates.empty()) throw std::runtime_error("Only forward requests take end dates");
+            if (trusted) return query;
+
+            CURVEMANAGER_TIME_SCOPE(registry, Timing::RequestValidation);
+            if (query.curve.empty()) throw std::runtime_error("The request has no curve");
+            const Date::serial_type first = Date::minDate().serialNumber(), last = Date::maxDate().serialNumber();
+            for (const auto* dates : {&query.dates, &query.endDates})
+                for (auto serial : *dates)
+                    if (serial < first || serial > last) throw std::runtime_error("Date serial number out of range: " + std::to_string(serial));
+            return query;
+        }
+
+        // the conventions left empty take the defaults of the JSON request
+        template <typename T>
+        json columnarConventions(const ColumnarQuery& query) {
+            json conventions = json::object();
+            if (!query.dayCounter.empty()) conventions["DAYCOUNTER"] = query.dayCounter;
+            if (!query.compounding.empty()) conventions["COMPOUNDING"] = query.compounding;
+            if (!query.frequency.empty()) conventions["FREQUENCY"] = query.frequency;
+            return cachedSchema<T>().setDefaultValues(conventions);
+        }
+    }  // namespace
+
     MarketStore::MarketStore(){};
 
+    MarketStore::~MarketStore() {
+        // curves and indexes are registered on shared observables, the evaluation date among them
+        EvaluationDateLock lock;
+        snapshot_.reset();
+        curves_.clear();
+        indexes_.clear();
+        quotes_.clear();
+    };
+
     boost::shared_ptr<YieldTermStructure> MarketStore::getCurve(const std::string& name) const {
-        if (hasCurve(name)) return curveMap_.at(name);
+        CurveId id = curveSymbols_.find(name);
+        if (id != SymbolTable::npos && curves_[id].curve) return curves_[id].curve;
         throw std::runtime_error("Curve not found: " + name);
     };
 
     boost::shared_ptr<IborIndex> MarketStore::getIndex(const std::string& name) const {
-        if (hasIndex(name)) return indexMap_.at(name);
+        uint32_t id = indexSymbols_.find(name);
+        if (id != SymbolTable::npos) return indexes_[id];
         throw std::runtime_error("Index not found: " + name);
     }
 
     Handle<Quote>& MarketStore::getQuote(const std::string& ticker) {
-        if (hasQuote(ticker)) return quoteMap_.at(ticker);
-        throw std::runtime_error("Index not found: " + ticker);
+        QuoteId id = quoteSymbols_.find(ticker);
+        if (id != SymbolTable::npos) return quotes_[id];
+        throw std::runtime_error("Quote not found: " + ticker);
     }
 
     RelinkableHandle<YieldTermStructure>& MarketStore::getCurveHandle(const std::string& name) {
-        if (hasCurveHandle(name)) return curveHandleMap_.at(name);
+        CurveId id = curveSymbols_.find(name);
+        if (id != SymbolTable::npos && curves_[id].hasHandle) return curves_[id].handle;
         throw std::runtime_error("Curve handle not found: " + name);
     }
 
+    CurveId MarketStore::curveId(const std::string& name) const {
+        CurveId id = curveSymbols_.find(name);
+        if (id == SymbolTable::npos) throw std::runtime_error("Curve not found: " + name);
+        return id;
+    }
+
+    QuoteId MarketStore::quoteId(const std::string& ticker) const {
+        QuoteId id = quoteSymbols_.find(ticker);
+        if (id == SymbolTable::npos) throw std::runtime_error("Quote not found: " + ticker);
+        return id;
+    }
+
+    const std::string& MarketStore::curveName(CurveId id) const {
+        return curveSymbols_.name(id);
+    }
+
+    const std::string& MarketStore::quoteTicker(QuoteId id) const {
+        return quoteSymbols_.name(id);
+    }
+
+    size_t MarketStore::curveIdCount() const {
+        return curveSymbols_.size();
+    }
+
+    size_t MarketStore::quoteIdCount() const {
+        return quoteSymbols_.size();
+    }
+
+    bool MarketStore::hasCurve(CurveId id) const {
+        return id < curves_.size() && curves_[id].curve;
+    }
+
+    boost::shared_ptr<YieldTermStructure> MarketStore::getCurve(CurveId id) const {
+        if (hasCurve(id)) return curves_[id].curve;
+        throw std::runtime_error("Curve not found: " + std::to_string(id));
+    }
+
+    const BootstrappedCurve& MarketStore::getBootstrappedCurve(const std::string& name) const {
+        CurveId id = curveSymbols_.find(name);
+        if (id != SymbolTable::npos && curves_[id].curve) return curves_[id].bootstrapped;
+        throw std::runtime_error("Curve not found: " + name);
+    }
+
+    const BootstrappedCurve& MarketStore::getBootstrappedCurve(CurveId id) const {
+        if (hasCurve(id)) return curves_[id].bootstrapped;
+        throw std::runtime_error("Curve not found: " + std::to_string(id));
+    }
+
+    Handle<Quote>& MarketStore::getQuote(QuoteId id) {
+        if (id < quotes_.size()) return quotes_[id];
+        throw std::runtime_error("Quote not found: " + std::to_string(id));
+    }
+
     bool MarketStore::hasCurve(const std::string& name) const {
-        if (curveMap_.find(name) != curveMap_.end()) return true;
-        return false;
+        CurveId id = curveSymbols_.find(name);
+        return id != SymbolTable::npos && curves_[id].curve;
     }
 
     bool MarketStore::hasIndex(const std::string& name) const {
-        if (indexMap_.find(name) != indexMap_.end()) return true;
-        return false;
+        return indexSymbols_.find(name) != SymbolTable::npos;
     }
+
     bool MarketStore::hasCurveHandle(const std::string& name) const {
-        return curveHandleMap_.find(name) != curveHandleMap_.end();
+        CurveId id = curveSymbols_.find(name);
+        return id != SymbolTable::npos && curves_[id].hasHandle;
     }
 
     bool MarketStore::hasQuote(const std::string& ticker) const {
-        return quoteMap_.find(ticker) != quoteMap_.end();
+        return quoteSymbols_.find(ticker) != SymbolTable::npos;
     }
 
     void MarketStore::addFixing(const std::string& name, const Date& date, double fixing) {
-        indexMap_[name]->addFixing(date, fixing, true);
+        getIndex(name)->addFixing(date, fixing, true);
+    }
+
+    size_t MarketStore::addFixings(const std::string& name, const std::vector<Date>& dates, const std::vector<double>& values) {
+        if (dates.size() != values.size()) throw std::runtime_error("Dates and values of the fixings of " + name + " do not match");
+        auto index = getIndex(name);
+        if (dates.empty()) return 0;
+        // the fixings notify the indexes, and through them the curves, of every store
+        EvaluationDateLock lock;
+        return addFixingsUnlocked(*index, dates, values);
+    }
+
+    size_t MarketStore::addFixingsUnlocked(IborIndex& index, const std::vector<Date>& dates, const std::vector<double>& values) {
+        index.addFixings(dates.begin(), dates.end(), values.begin(), true);
+        return dates.size();
+    }
+
+    size_t MarketStore::addFixings(const FixingsTable& fixings) {
+        for (const auto& [name, series] : fixings) {
+            if (!hasIndex(name)) throw std::runtime_error("Index not found: " + name);
+            if (series.dates.size() != series.values.size()) throw std::runtime_error("Dates and values of the fixings of " + name + " do not match");
+        }
+        EvaluationDateLock lock;
+        size_t added = 0;
+        for (const auto& [name, series] : fixings)
+            if (!series.dates.empty()) added += addFixingsUnlocked(*getIndex(name), series.dates, series.values);
+        return added;
+    }
+
+    size_t MarketStore::loadFixings(const std::string& path) {
+        return addFixings(readFixings(path));
     }
 
     void MarketStore::addCurve(const std::string& name, boost::shared_ptr<YieldTermStructure>& curve) {
-        curveMap_[name] = curve;
+        CurveId id = curveSymbols_.intern(name);
+        if (id == curves_.size()) curves_.emplace_back();
+        curves_[id].curve        = curve;
+        curves_[id].bootstrapped = BootstrappedCurve();
+    }
+
+    void MarketStore::addCurve(const std::string& name, const BootstrappedCurve& curve) {
+        CurveId id = curveSymbols_.intern(name);
+        if (id == curves_.size()) curves_.emplace_back();
+        curves_[id].curve        = curve.termStructure();
+        curves_[id].bootstrapped = curve;
     }
 
     void MarketStore::addIndex(const std::string& name, boost::shared_ptr<IborIndex>& index) {
-        indexMap_[name] = index;
+        uint32_t id = indexSymbols_.intern(name);
+        if (id == indexes_.size()) indexes_.emplace_back();
+        indexes_[id] = index;
     }
 
     void MarketStore::addQuote(const std::string& ticker, Handle<Quote>& handle) {
-        quoteMap_.insert({ticker, handle});
+        QuoteId id = quoteSymbols_.intern(ticker);
+        if (id == quotes_.size()) quotes_.push_back(handle);
     }
 
     void MarketStore::addCurveHandle(const std::string& name, RelinkableHandle<YieldTermStructure>& handle) {
-        curveHandleMap_.insert({name, handle});
+        CurveId id = curveSymbols_.intern(name);
+        if (id == curves_.size()) curves_.emplace_back();
+        if (curves_[id].hasHandle) return;
+        curves_[id].handle    = handle;
+        curves_[id].hasHandle = true;
     }
 
-    void MarketStore::freeze() {
-        for (const auto& [name, curve] : curveMap_) {
-            auto ptr = boost::dynamic_pointer_cast<PiecewiseYieldCurve<Discount, LogLinear>>(curve);
-            if (ptr) ptr->freeze();
+    void MarketStore::removeCurve(const std::string& name) {
+        CurveId id = curveSymbols_.find(name);
+        if (id == SymbolTable::npos) return;
+        CurveSlot& slot = curves_[id];
+        if (slot.bootstrapped) {
+            try {
+                auto seed       = boost::make_shared<CurveSeed>();
+                seed->dates     = slot.bootstrapped.dates();
+                seed->discounts = slot.bootstrapped.nodeDiscounts();
+                slot.seed       = seed;
+            }
+            catch (const std::exception&) {
+                // a curve that fails to bootstrap leaves no seed
+                slot.seed.reset();
+            }
         }
+        slot.curve.reset();
+        slot.bootstrapped = BootstrappedCurve();
+    }
+
+    boost::shared_ptr<const CurveSeed> MarketStore::curveSeed(const std::string& name) const {
+        CurveId id = curveSymbols_.find(name);
+        return id != SymbolTable::npos ? curves_[id].seed : nullptr;
+    }
+
+    void MarketStore::freeze() {
+        for (const auto& slot : curves_)
+            if (slot.bootstrapped) slot.bootstrapped.freeze();
     }
 
     void MarketStore::unfreeze() {
-        for (const auto& [name, curve] : curveMap_) {
-            auto ptr = boost::dynamic_pointer_cast<PiecewiseYieldCurve<Discount, LogLinear>>(curve);
-            if (ptr) ptr->unfreeze();
+        for (const auto& slot : curves_)
+            if (slot.bootstrapped) slot.bootstrapped.unfreeze();
+    }
+
+    void MarketStore::freeze(const std::vector<std::string>& names) {
+        for (const auto& name : names) {
+            const BootstrappedCurve& curve = getBootstrappedCurve(name);
+            if (curve) curve.freeze();
+        }
+    }
+
+    void MarketStore::unfreeze(const std::vector<std::string>& names) {
+        for (const auto& name : names) {
+            const BootstrappedCurve& curve = getBootstrappedCurve(name);
+            if (curve) curve.unfreeze();
+        }
+    }
+
+    void MarketStore::recalculate(const std::vector<std::string>& names) {
+        // names must be sorted so that every curve comes after the curves it depends on
+        for (const auto& name : names) {
+            const BootstrappedCurve& curve = getBootstrappedCurve(name);
+            if (curve) curve.recalculate();
         }
     }
 
     std::vector<std::string> MarketStore::allCurves() const {
         std::vector<std::string> names;
-        for (const auto& [name, curve] : curveMap_) names.push_back(name);
+        for (CurveId id = 0; id < curves_.size(); ++id)
+            if (curves_[id].curve) names.push_back(curveSymbols_.name(id));
         return names;
     }
 
     std::vector<std::string> MarketStore::allIndexes() const {
         std::vector<std::string> names;
-        for (const auto& [name, index] : indexMap_) names.push_back(name);
+        for (uint32_t id = 0; id < indexes_.size(); ++id) names.push_back(indexSymbols_.name(id));
         return names;
     }
 
+    std::vector<std::string> MarketStore::allQuotes() const {
+        std::vector<std::string> tickers;
+        for (QuoteId id = 0; id < quotes_.size(); ++id) tickers.push_back(quoteSymbols_.name(id));
+        return tickers;
+    }
+
     json MarketStore::bootstrapResults() const {
         std::vector<Date> qlDates;
         json results = json::array();
 
-        for (const auto& [name, curve] : curveMap_) {
-            auto ptr = boost::dynamic_pointer_cast<PiecewiseYieldCurve<Discount, LogLinear>>(curve);
-            if (ptr) {
+        for (CurveId id = 0; id < curves_.size(); ++id) {
+            const BootstrappedCurve& curve = curves_[id].bootstrapped;
+            if (curve) {
+                // VALUES are in the units of TRAITS: discounts, zero rates or instantaneous forwards
                 json data;
-                auto nodes   = ptr->nodes();
-                data["NAME"] = name;
-                std::vector<double> values;
+                data["NAME"]          = curveSymbols_.name(id);
+                data["TRAITS"]        = curve.traits();
+                data["INTERPOLATION"] = curve.interpolation();
                 std::vector<std::string> dates;
-                for (const auto& pair : nodes) {
-                    dates.push_back(parseDate(pair.first, DateFormat::MIXED));
-                    values.push_back(pair.second);
-                }
+                for (const auto& date : curve.dates()) dates.push_back(cachedFormatDate(date));
                 data["DATES"]  = dates;
-                data["VALUES"] = values;
+                data["VALUES"] = curve.data();
                 results.push_back(data);
             }
         }
         return results;
     }
 
-    json MarketStore::discountRequest(const json& request) const {
+    json MarketStore::metrics() const {
+        return metricsRegistry_.toJSON();
+    }
+
+    std::string MarketStore::prometheusMetrics() const {
+        return metricsRegistry_.toPrometheus();
+    }
+
+    MetricsRegistry& MarketStore::metricsRegistry() const {
+        return metricsRegistry_;
+    }
+
+    bool MarketStore::hasJacobian(const std::string& name) const {
+        return jacobianMap_.find(name) != jacobianMap_.end();
+    }
+
+    const CurveJacobian& MarketStore::getJacobian(const std::string& name) const {
+        if (hasJacobian(name)) return jacobianMap_.at(name);
+        throw std::runtime_error("Jacobian not found: " + name);
+    }
+
+    void MarketStore::addJacobian(const std::string& name, const CurveJacobian& jacobian) {
+        jacobianMap_[name] = jacobian;
+    }
+
+    uint64_t MarketStore::publishSnapshot() {
+        auto previous                                 = std::atomic_load(&snapshot_);
+        std::shared_ptr<const CurveSnapshot> snapshot = std::make_shared<const CurveSnapshot>(*this, previous ? previous->epoch() + 1 : 1);
+        std::atomic_store(&snapshot_, snapshot);
+        return snapshot->epoch();
+    }
+
+    uint64_t MarketStore::publishSnapshot(const std::vector<std::string>& changedCurves) {
+        auto previous = std::atomic_load(&snapshot_);
+        if (!previous) return publishSnapshot();
+        std::shared_ptr<const CurveSnapshot> snapshot = std::make_shared<const CurveSnapshot>(*this, *previous, changedCurves);
+        std::atomic_store(&snapshot_, snapshot);
+        return snapshot->epoch();
+    }
+
+    std::shared_ptr<const CurveSnapshot> MarketStore::snapshot() const {
+        auto current = std::atomic_load(&snapshot_);
+        if (!current) throw std::runtime_error("No snapshot has been published");
+        return current;
+    }
+
+    EpochHandle MarketStore::pin() const {
+        return EpochHandle(snapshot());
+    }
+
+    void MarketStore::setVersioned(bool versioned) {
+        versioned_ = versioned;
+    }
+
+    bool MarketStore::isVersioned() const {
+        return versioned_;
+    }
+
+    void MarketStore::setTrustedInput(bool trusted) {
+        trustedInput_ = trusted;
+    }
+
+    bool MarketStore::isTrustedInput() const {
+        return trustedInput_;
+    }
+
+    std::shared_ptr<const CurveSnapshot> MarketStore::versionedSnapshot(CurveId curve) const {
+        if (!versioned_) return nullptr;
+        auto current = std::atomic_load(&snapshot_);
+        if (!current) return nullptr;
+        // the live curve may be rebootstrapped while it is read
+        if (!current->hasCurve(curve)) throw std::runtime_error("Curve not in the published snapshot: " + curveName(curve));
+        return current;
+    }
+
+    void MarketStore::discounts(const std::string& curve, const Date::serial_type* dates, size_t n, double* out) const {
+        discounts(curveId(curve), dates, n, out);
+    }
+
+    void MarketStore::discounts(const std::string& curve, const Time* times, size_t n, double* out) const {
+        discounts(curveId(curve), times, n, out);
+    }
+
+    void MarketStore::zeroRates(const std::string& curve,
+                                const Date::serial_type* dates,
+                                size_t n,
+                                const DayCounter& dayCounter,
+                                Compounding comp,
+                                Frequency freq,
+                                double* out) const {
+        zeroRates(curveId(curve), dates, n, dayCounter, comp, freq, out);
+    }
+
+    void MarketStore::forwardRates(const std::string& curve,
+                                   const Date::serial_type* startDates,
+                                   const Date::serial_type* endDates,
+                                   size_t n,
+                                   const DayCounter& dayCounter,
+                                   Compounding comp,
+                                   Frequency freq,
+                                   double* out) const {
+        forwardRates(curveId(curve), startDates, endDates, n, dayCounter, comp, freq, out);
+    }
+
+    void MarketStore::discountsOn(const CurveSnapshot* snapshot, CurveId curve, const Date::serial_type* dates, size_t n, double* out) const {
+        if (snapshot) return snapshot->curve(curve).discounts(dates, n, out);
+        auto curvePtr = getCurve(curve);
+        for (size_t i = 0; i < n; ++i) out[i] = curvePtr->discount(Date(dates[i]));
+    }
+
+    void MarketStore::discountsOn(const CurveSnapshot* snapshot, CurveId curve, const Time* times, size_t n, double* out) const {
+        if (snapshot) return snapshot->curve(curve).discounts(times, n, out);
+        auto curvePtr = getCurve(curve);
+        for (size_t i = 0; i < n; ++i) out[i] = curvePtr->discount(times[i]);
+    }
+
+    void MarketStore::discounts(CurveId curve, const Date::serial_type* dates, size_t n, double* out) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::Discounts);
+        discountsOn(versionedSnapshot(curve).get(), curve, dates, n, out);
+    }
+
+    void MarketStore::discounts(CurveId curve, const Time* times, size_t n, double* out) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::Discounts);
+        discountsOn(versionedSnapshot(curve).get(), curve, times, n, out);
+    }
+
+    void MarketStore::zeroRates(CurveId curve,
+                                const Date::serial_type* dates,
+                                size_t n,
+                                const DayCounter& dayCounter,
+                                Compounding comp,
+                                Frequency freq,
+                                double* out) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ZeroRates);
+        // every date is read from the same epoch
+        zeroRatesOn(versionedSnapshot(curve).get(), curve, dates, n, dayCounter, comp, freq, out);
+    }
+
+    void MarketStore::forwardRates(CurveId curve,
+                                   const Date::serial_type* startDates,
+                                   const Date::serial_type* endDates,
+                                   size_t n,
+                                   const DayCounter& dayCounter,
+                                   Compounding comp,
+                                   Frequency freq,
+                                   double* out) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ForwardRates);
+        forwardRatesOn(versionedSnapshot(curve).get(), curve, startDates, endDates, n, dayCounter, comp, freq, out);
+    }
+
+    void MarketStore::zeroRatesOn(const CurveSnapshot* snapshot,
+                                  CurveId curve,
+                                  const Date::serial_type* dates,
+                                  size_t n,
+                                  const DayCounter& dayCounter,
+                                  Compounding comp,
+                                  Frequency freq,
+                                  double* out) const {
+        Date refDate = snapshot ? snapshot->curve(curve).referenceDate() : getCurve(curve)->referenceDate();
+        std::vector<double> times(n), dfs(n);
+        discountsOn(snapshot, curve, dates, n, dfs.data());
+        for (size_t i = 0; i < n; ++i) {
+            Date date = Date(dates[i]);
+            if (date == refDate) {
+                // same convention as YieldTermStructure::zeroRate at the reference date
+                times[i] = 0.0001;
+                discountsOn(snapshot, curve, &times[i], 1, &dfs[i]);
+            }
+            else {
+                times[i] = dayCounter.yearFraction(refDate, date);
+            }
+        }
+        if (!zeroRatesFromDiscounts(dfs.data(), times.data(), n, comp, freq, out)) {
+            for (size_t i = 0; i < n; ++i) out[i] = InterestRate::impliedRate(1.0 / dfs[i], dayCounter, comp, freq, times[i]).rate();
+        }
+    }
+
+    void MarketStore::forwardRatesOn(const CurveSnapshot* snapshot,
+                                     CurveId curve,
+                                     const Date::serial_type* startDates,
+                                     const Date::serial_type* endDates,
+                                     size_t n,
+                                     const DayCounter& dayCounter,
+                                     Compounding comp,
+                                     Frequency freq,
+                                     double* out) const {
+        if (!snapshot) {
+            auto curvePtr = getCurve(curve);
+            for (size_t i = 0; i < n; ++i)
+                out[i] = curvePtr->forwardRate(Date(startDates[i]), Date(endDates[i]), dayCounter, comp, freq).rate();
+            return;
+        }
+
+        // same conventions as YieldTermStructure::forwardRate, evaluated on the compiled curve
+        const CompiledCurve& compiled = snapshot->curve(curve);
+        const Time dt                 = 0.0001;
+        std::vector<double> ratios(n), times(n);
+        for (size_t i = 0; i < n; ++i) {
+            Date startDate(startDates[i]), endDate(endDates[i]);
+            if (startDate == endDate) {
+                Time t1   = std::max(compiled.timeFromReference(startDate) - dt / 2.0, 0.0);
+                ratios[i] = compiled.discount(t1 + dt) / compiled.discount(t1);
+                times[i]  = dt;
+            }
+            else {
+                ratios[i] = compiled.discount(compiled.timeFromReference(endDate)) / compiled.discount(compiled.timeFromReference(startDate));
+                times[i]  = dayCounter.yearFraction(startDate, endDate);
+            }
+        }
+        if (!zeroRatesFromDiscounts(ratios.data(), times.data(), n, comp, freq, out)) {
+            for (size_t i = 0; i < n; ++i) out[i] = InterestRate::impliedRate(1.0 / ratios[i], dayCounter, comp, freq, times[i]).rate();
+        }
+    }
+
+    json MarketStore::discountQuery(const json& request, std::vector<Date::serial_type>& dates, std::vector<double>& values) const {
         //shoulnt require ref date (not the same for the microservice)
-        Schema<DiscountFactorsRequest> schema;
-        schema.validate(request);
+        auto& schema = cachedSchema<DiscountFactorsRequest>();
+        if (!trustedInput_) validateRequest(schema, request, metricsRegistry_);
+        json data = schema.setDefaultValues(request);
+
+        dates.clear();
+        dates.reserve(data.at("DATES").size());
+        for (const auto& date : data.at("DATES")) dates.push_back(cachedParseDate(date).serialNumber());
+        values.resize(dates.size());
+        CurveId curve = curveId(data.at("CURVE").get<std::string>());
+        discountsOn(versionedSnapshot(curve).get(), curve, dates.data(), dates.size(), values.data());
+        return data;
+    }
+
+    json MarketStore::zeroRateQuery(const json& request, std::vector<Date::serial_type>& dates, std::vector<double>& values) const {
+        auto& schema = cachedSchema<ZeroRatesRequests>();
+        if (!trustedInput_) validateRequest(schema, request, metricsRegistry_);
         json data = schema.setDefaultValues(request);
 
-        auto curve = getCurve(data.at("CURVE"));
+        DayCounter dayCounter = parse<DayCounter>(data.at("DAYCOUNTER"));
+        Compounding comp      = parse<Compounding>(data.at("COMPOUNDING"));
+        Frequency freq        = parse<Frequency>(data.at("FREQUENCY"));
+
+        dates.clear();
+        dates.reserve(data.at("DATES").size());
+        for (const auto& date : data.at("DATES")) dates.push_back(cachedParseDate(date).serialNumber());
+        values.resize(dates.size());
+        CurveId curve = curveId(data.at("CURVE").get<std::string>());
+        zeroRatesOn(versionedSnapshot(curve).get(), curve, dates.data(), dates.size(), dayCounter, comp, freq, values.data());
+        return data;
+    }
 
-        json response = json::array();
-        for (const auto& date : data.at("DATES")) {
+    json MarketStore::discountRequest(const json& request) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::DiscountRequest);
+        std::vector<Date::serial_type> serials;
+        std::vector<double> values;
+        json data = discountQuery(request, serials, values);
+
+        const json& dates = data.at("DATES");
+        json response     = json::array();
+        for (size_t i = 0; i < values.size(); ++i) {
             json row;
-            row["DATE"]  = date;
-            row["VALUE"] = curve->discount(parse<Date>(date));
+            row["DATE"]  = dates[i];
+            row["VALUE"] = values[i];
             response.push_back(row);
         }
         return response;
     }
 
     json MarketStore::zeroRateRequest(const json& request) const {
-        Schema<ZeroRatesRequests> schema;
-        schema.validate(request);
-        json data = schema.setDefaultValues(request);
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ZeroRateRequest);
+        std::vector<Date::serial_type> serials;
+        std::vector<double> values;
+        json data = zeroRateQuery(request, serials, values);
 
-        auto curve            = getCurve(data.at("CURVE"));
-        DayCounter dayCounter = parse<DayCounter>(data.at("DAYCOUNTER"));
-        Compounding comp      = parse<Compounding>(data.at("COMPOUNDING"));
-        Frequency freq        = parse<Frequency>(data.at("FREQUENCY"));
-        json response         = json::array();
-        for (const auto& date : data.at("DATES")) {
+        const json& dates = data.at("DATES");
+        json response     = json::array();
+        for (size_t i = 0; i < values.size(); ++i) {
             json row;
-            row["DATE"]  = date;
-            row["VALUE"] = curve->discount(parse<Date>(date));
+            row["DATE"]  = dates[i];
+            row["VALUE"] = values[i];
             response.push_back(row);
         }
         return response;
     }
 
-    json MarketStore::forwardRateRequest(const json& request) const {
-        Schema<ForwardRatesRequest> schema;
-        schema.validate(request);
+    const std::vector<uint8_t>& MarketStore::discountRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::DiscountRequest);
+        std::vector<double> values;
+        if (encoding == Encoding::Columnar) {
+            // no conventions involved: the dates go straight to the batch query
+            ColumnarQuery query = decodeColumnarRequest(data, size, false, trustedInput_, metricsRegistry_);
+            values.resize(query.dates.size());
+            CurveId curve = curveId(query.curve);
+            discountsOn(versionedSnapshot(curve).get(), curve, query.dates.data(), query.dates.size(), values.data());
+            return encoder.encode(query.dates.data(), values.data(), values.size());
+        }
+        std::vector<Date::serial_type> dates;
+        discountQuery(decodeDocument(data, size, encoding), dates, values);
+        return encoder.encode(dates.data(), values.data(), values.size());
+    }
+
+    const std::vector<uint8_t>& MarketStore::zeroRateRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ZeroRateRequest);
+        std::vector<Date::serial_type> dates;
+        std::vector<double> values;
+        if (encoding != Encoding::Columnar) {
+            zeroRateQuery(decodeDocument(data, size, encoding), dates, values);
+            return encoder.encode(dates.data(), values.data(), values.size());
+        }
+
+        ColumnarQuery query = decodeColumnarRequest(data, size, false, trustedInput_, metricsRegistry_);
+        json conventions    = columnarConventions<ZeroRatesRequests>(query);
+        values.resize(query.dates.size());
+        CurveId curve = curveId(query.curve);
+        zeroRatesOn(versionedSnapshot(curve).get(),
+                    curve,
+                    query.dates.data(),
+                    query.dates.size(),
+                    parse<DayCounter>(conventions.at("DAYCOUNTER")),
+                    parse<Compounding>(conventions.at("COMPOUNDING")),
+                    parse<Frequency>(conventions.at("FREQUENCY")),
+                    values.data());
+        return encoder.encode(query.dates.data(), values.data(), values.size());
+    }
+
+    json MarketStore::forwardRateQuery(const json& request,
+                                       std::vector<Date::serial_type>& startDates,
+                                       std::vector<Date::serial_type>& endDates,
+                                       std::vector<double>& values) const {
+        auto& schema = cachedSchema<ForwardRatesRequest>();
+        if (!trustedInput_) validateRequest(schema, request, metricsRegistry_);
         json data = schema.setDefaultValues(request);
 
-        auto curve            = getCurve(data.at("CURVE"));
         DayCounter dayCounter = parse<DayCounter>(data.at("DAYCOUNTER"));
         Compounding comp      = parse<Compounding>(data.at("COMPOUNDING"));
         Frequency freq        = parse<Frequency>(data.at("FREQUENCY"));
+
+        const json& dates = data.at("DATES");
+        startDates.clear();
+        endDates.clear();
+        startDates.reserve(dates.size());
+        endDates.reserve(dates.size());
+        for (const auto& pair : dates) {
+            startDates.push_back(cachedParseDate(pair.at(0)).serialNumber());
+            endDates.push_back(cachedParseDate(pair.at(1)).serialNumber());
+        }
+        values.resize(startDates.size());
+        CurveId curve = curveId(data.at("CURVE").get<std::string>());
+        auto snapshot = versionedSnapshot(curve);
+        forwardRatesOn(snapshot.get(), curve, startDates.data(), endDates.data(), values.size(), dayCounter, comp, freq, values.data());
+        return data;
+    }
+
+    json MarketStore::forwardRateRequest(const json& request) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ForwardRateRequest);
+        std::vector<Date::serial_type> startDates, endDates;
+        std::vector<double> values;
+        forwardRateQuery(request, startDates, endDates, values);
+
         json response;
-        response["VALUES"] = json::array();
-        for (const auto& dates : data.at("DATES")) {
-            auto startDate = parse<Date>(dates[0]);
-            auto endDate   = parse<Date>(dates[1]);
-            response["VALUES"].push_back(curve->forwardRate(startDate, endDate, dayCounter, comp, freq).rate());
+        response["VALUES"] = values;
+        response["DATES"]  = request["DATES"];
+        return response;
+    }
+
+    const std::vector<uint8_t>& MarketStore::forwardRateRequest(const uint8_t* data, size_t size, Encoding encoding, ResponseEncoder& encoder) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::ForwardRateRequest);
+        std::vector<Date::serial_type> startDates, endDates;
+        std::vector<double> values;
+        if (encoding != Encoding::Columnar) {
+            forwardRateQuery(decodeDocument(data, size, encoding), startDates, endDates, values);
+            return encoder.encode(startDates.data(), endDates.data(), values.data(), values.size());
         }
-        response["DATES"] = request["DATES"];
+
+        ColumnarQuery query = decodeColumnarRequest(data, size, true, trustedInput_, metricsRegistry_);
+        json conventions    = columnarConventions<ForwardRatesRequest>(query);
+        values.resize(query.dates.size());
+        CurveId curve = curveId(query.curve);
+        forwardRatesOn(versionedSnapshot(curve).get(),
+                       curve,
+                       query.dates.data(),
+                       query.endDates.data(),
+                       values.size(),
+                       parse<DayCounter>(conventions.at("DAYCOUNTER")),
+                       parse<Compounding>(conventions.at("COMPOUNDING")),
+                       parse<Frequency>(conventions.at("FREQUENCY")),
+                       values.data());
+        return encoder.encode(query.dates.data(), query.endDates.data(), values.data(), values.size());
+    }
+
+    json MarketStore::jacobianRequest(const json& request) const {
+        CURVEMANAGER_TIME_SCOPE(metricsRegistry_, Timing::JacobianRequest);
+        auto& schema = cachedSchema<JacobianRequest>();
+        if (!trustedInput_) validateRequest(schema, request, metricsRegistry_);
+
+        const std::string& name       = request.at("CURVE");
+        const CurveJacobian& jacobian = getJacobian(name);
+        std::vector<std::string> dates;
+        for (const auto& date : jacobian.dates) dates.push_back(cachedFormatDate(date));
+
+        json values = json::array();
+        for (Size j = 0; j < jacobian.values.rows(); ++j)
+            values.push_back(std::vector<double>(jacobian.values.row_begin(j), jacobian.values.row_end(j)));
+
+        json response;
+        response["CURVE"]    = name;
+        response["DATES"]    = dates;
+        response["TICKERS"]  = jacobian.tickers;
+        response["JACOBIAN"] = values;
         return response;
     }
 }  // namespace CurveManager
@@ -0,0 +1,173 @@
+#include <curvemanager/metrics.hpp>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace CurveManager
+{
+    namespace
+    {
+        struct TimingInfo {
+            const char* name;
+            const char* family;
+            const char* label;
+        };
+
+        // name in the JSON snapshot, Prometheus metric family and label
+        const std::array<TimingInfo, static_cast<size_t>(Timing::Count)> timingInfo = {{
+            {"DISCOUNTREQUEST", "curvemanager_query_latency_seconds", "endpoint=\"discountRequest\""},
+            {"ZERORATEREQUEST", "curvemanager_query_latency_seconds", "endpoint=\"zeroRateRequest\""},
+            {"FORWARDRATEREQUEST", "curvemanager_query_latency_seconds", "endpoint=\"forwardRateRequest\""},
+            {"JACOBIANREQUEST", "curvemanager_query_latency_seconds", "endpoint=\"jacobianRequest\""},
+            {"DISCOUNTS", "curvemanager_query_latency_seconds", "endpoint=\"discounts\""},
+            {"ZERORATES", "curvemanager_query_latency_seconds", "endpoint=\"zeroRates\""},
+            {"FORWARDRATES", "curvemanager_query_latency_seconds", "endpoint=\"forwardRates\""},
+            {"QUOTEUPDATE", "curvemanager_quote_update_seconds", ""},
+            {"REQUESTVALIDATION", "curvemanager_schema_validation_seconds", "schema=\"request\""},
+            {"CURVECONFIGVALIDATION", "curvemanager_schema_validation_seconds", "schema=\"curveConfig\""},
+            {"QUOTEUPDATEVALIDATION", "curvemanager_schema_validation_seconds", "schema=\"quoteUpdate\""},
+        }};
+
+        std::string labels(const std::string& label, const std::string& extra) {
+            if (label.empty() && extra.empty()) return "";
+            if (label.empty() || extra.empty()) return "{" + label + extra + "}";
+            return "{" + label + "," + extra + "}";
+        }
+
+        std::string bucketLabel(double boundMicros) {
+            if (std::isinf(boundMicros)) return "le=\"+Inf\"";
+            std::ostringstream out;
+            out << "le=\"" << boundMicros * 1e-6 << "\"";
+            return out.str();
+        }
+    }  // namespace
+
+    void LatencyHistogram::record(double micros) {
+        uint64_t rounded = micros > 0.0 ? static_cast<uint64_t>(std::ceil(micros)) : 0;
+        size_t bucket    = rounded > 1 ? std::bit_width(rounded - 1) : 0;
+        if (bucket >= nBuckets) bucket = nBuckets - 1;
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumNanos_.fetch_add(static_cast<uint64_t>(micros * 1000.0), std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sumNanos_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::sum() const {
+        return sumNanos_.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+    uint64_t LatencyHistogram::bucketCount(size_t i) const {
+        return buckets_.at(i).load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::bucketBound(size_t i) {
+        if (i + 1 >= nBuckets) return std::numeric_limits<double>::infinity();
+        return static_cast<double>(uint64_t(1) << i);
+    }
+
+    void MetricsRegistry::recordBootstrap(const std::string& curve, double elapsedMs, uint64_t solverIterations, size_t helpers) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CurveMetrics& metrics    = curves_[curve];
+        metrics.lastBootstrapMs  = elapsedMs;
+        metrics.totalBootstrapMs += elapsedMs;
+        metrics.bootstraps++;
+        metrics.solverIterations = solverIterations;
+        metrics.helpers          = helpers;
+    }
+
+    CurveMetrics MetricsRegistry::curveMetrics(const std::string& curve) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = curves_.find(curve);
+        if (it == curves_.end()) throw std::runtime_error("No metrics found for curve " + curve);
+        return it->second;
+    }
+
+    void MetricsRegistry::reset() {
+        for (auto& histogram : histograms_) histogram.reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        curves_.clear();
+    }
+
+    json MetricsRegistry::toJSON() const {
+        json results;
+#ifdef CURVEMANAGER_METRICS
+        results["ENABLED"] = true;
+#else
+        results["ENABLED"] = false;
+#endif
+        json timings;
+        for (size_t t = 0; t < histograms_.size(); ++t) {
+            const LatencyHistogram& histogram = histograms_[t];
+            json data;
+            data["COUNT"] = histogram.count();
+            data["SUM"]   = histogram.sum();
+            std::vector<uint64_t> buckets;
+            for (size_t i = 0; i < LatencyHistogram::nBuckets; ++i) buckets.push_back(histogram.bucketCount(i));
+            data["BUCKETS"]             = buckets;
+            timings[timingInfo[t].name] = data;
+        }
+        results["UNIT"]    = "MICROSECONDS";
+        results["TIMINGS"] = timings;
+
+        json curves = json::object();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, metrics] : curves_) {
+            json data;
+            data["LASTBOOTSTRAPMS"]  = metrics.lastBootstrapMs;
+            data["TOTALBOOTSTRAPMS"] = metrics.totalBootstrapMs;
+            data["BOOTSTRAPS"]       = metrics.bootstraps;
+            data["SOLVERITERATIONS"] = metrics.solverIterations;
+            data["HELPERS"]          = metrics.helpers;
+            curves[name]             = data;
+        }
+        results["CURVES"] = curves;
+        return results;
+    }
+
+    std::string MetricsRegistry::toPrometheus() const {
+        std::ostringstream out;
+        out.precision(9);
+
+        std::map<std::string, std::vector<size_t>> families;
+        for (size_t t = 0; t < histograms_.size(); ++t) families[timingInfo[t].family].push_back(t);
+        for (const auto& [family, timings] : families) {
+            out << "# TYPE " << family << " histogram\n";
+            for (size_t t : timings) {
+                const LatencyHistogram& histogram = histograms_[t];
+                const std::string label           = timingInfo[t].label;
+                uint64_t cumulative               = 0;
+                for (size_t i = 0; i < LatencyHistogram::nBuckets; ++i) {
+                    cumulative += histogram.bucketCount(i);
+                    out << family << "_bucket" << labels(label, bucketLabel(LatencyHistogram::bucketBound(i))) << " " << cumulative << "\n";
+                }
+                out << family << "_sum" << labels(label, "") << " " << histogram.sum() * 1e-6 << "\n";
+                out << family << "_count" << labels(label, "") << " " << histogram.count() << "\n";
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto gauge = [&](const std::string& metric, const std::string& type, auto value) {
+            out << "# TYPE " << metric << " " << type << "\n";
+            for (const auto& [name, metrics] : curves_) out << metric << "{curve=\"" << name << "\"} " << value(metrics) << "\n";
+        };
+        gauge("curvemanager_curve_bootstrap_seconds", "gauge", [](const CurveMetrics& m) { return m.lastBootstrapMs * 1e-3; });
+        gauge("curvemanager_curve_bootstrap_seconds_total", "counter", [](const CurveMetrics& m) { return m.totalBootstrapMs * 1e-3; });
+        gauge("curvemanager_curve_bootstraps_total", "counter", [](const CurveMetrics& m) { return m.bootstraps; });
+        gauge("curvemanager_curve_solver_iterations", "gauge", [](const CurveMetrics& m) { return m.solverIterations; });
+        gauge("curvemanager_curve_helpers", "gauge", [](const CurveMetrics& m) { return m.helpers; });
+        return out.str();
+    }
+}  // namespace CurveManager
@@ -0,0 +1,139 @@
+#include <curvemanager/quotequeue.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace CurveManager
+{
+    QuoteQueue::QuoteQueue(CurveBuilder& builder, MarketStore& marketStore, size_t maxBatch, std::chrono::milliseconds interval)
+    : builder_(builder), nQuotes_(marketStore.quoteIdCount()), ready_(std::max<size_t>(1, nQuotes_)), maxBatch_(std::max<size_t>(1, maxBatch)),
+      interval_(interval) {
+        // a ticker is queued at most once until it is applied, so the ring never fills up
+        slots_ = std::make_unique<Slot[]>(nQuotes_);
+        for (QuoteId id = 0; id < nQuotes_; ++id) quoteIds_[marketStore.quoteTicker(id)] = id;
+    };
+
+    QuoteQueue::~QuoteQueue() {
+        try {
+            stop();
+        }
+        catch (...) {
+        }
+    };
+
+    bool QuoteQueue::push(const std::string& ticker, double value) {
+        auto it = quoteIds_.find(ticker);
+        return push(it == quoteIds_.end() ? SymbolTable::npos : it->second, value);
+    }
+
+    bool QuoteQueue::push(QuoteId quote, double value) {
+        received_.fetch_add(1, std::memory_order_relaxed);
+        if (quote >= nQuotes_ || !std::isfinite(value)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Slot& slot = slots_[quote];
+        slot.value.store(value);
+        if (slot.pending.exchange(true)) {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        // counted before it is visible to flush, so that the depth never goes below zero
+        size_t depth = depth_.fetch_add(1) + 1;
+        ready_.push(quote);
+        // a wake up lost to a concurrent wait is picked up at the next interval at the latest
+        if (depth == maxBatch_) wake_.notify_one();
+        return true;
+    }
+
+    size_t QuoteQueue::flush() {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        std::vector<QuoteId> quotes;
+        std::vector<double> values;
+        QuoteId id;
+        while (ready_.pop(id)) {
+            depth_.fetch_sub(1);
+            // cleared before reading, so a tick arriving now is queued again instead of being lost
+            Slot& slot = slots_[id];
+            slot.pending.store(false);
+            quotes.push_back(id);
+            values.push_back(slot.value.load());
+        }
+        if (quotes.empty()) return 0;
+
+        try {
+            builder_.updateQuotes(quotes, values);
+        }
+        catch (...) {
+            dropped_.fetch_add(quotes.size(), std::memory_order_relaxed);
+            throw;
+        }
+        applied_.fetch_add(quotes.size(), std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        return quotes.size();
+    }
+
+    void QuoteQueue::start() {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (running_) return;
+        running_ = true;
+        worker_  = std::thread([this]() { run(); });
+    }
+
+    void QuoteQueue::stop() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        wake_.notify_one();
+        worker_.join();
+        flush();
+    }
+
+    bool QuoteQueue::isRunning() const {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        return running_;
+    }
+
+    void QuoteQueue::run() {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        while (running_) {
+            wake_.wait_for(lock, interval_, [this]() { return !running_ || depth_.load() >= maxBatch_; });
+            lock.unlock();
+            try {
+                flush();
+            }
+            catch (...) {
+                // the failed batch is counted as dropped; the feed keeps going
+            }
+            lock.lock();
+        }
+    }
+
+    size_t QuoteQueue::replay(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Cannot open replay file " + path);
+        size_t lines = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            json tick = json::parse(line);
+            push(tick.at("NAME").get<std::string>(), tick.at("VALUE").get<double>());
+            ++lines;
+        }
+        return lines;
+    }
+
+    QuoteQueueStats QuoteQueue::stats() const {
+        QuoteQueueStats stats;
+        stats.depth     = depth_.load();
+        stats.received  = received_.load(std::memory_order_relaxed);
+        stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+        stats.dropped   = dropped_.load(std::memory_order_relaxed);
+        stats.applied   = applied_.load(std::memory_order_relaxed);
+        stats.batches   = batches_.load(std::memory_order_relaxed);
+        return stats;
+    }
+}  // namespace CurveManager
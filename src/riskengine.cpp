@@ -0,0 +1,87 @@
+#include <curvemanager/riskengine.hpp>
+#include "utils/threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace CurveManager
+{
+    namespace
+    {
+        std::vector<CurveId> curveIds(const MarketStore& store, const std::vector<std::string>& curves) {
+            std::vector<CurveId> ids;
+            for (const auto& curve : curves) ids.push_back(store.curveId(curve));
+            return ids;
+        }
+
+        void discounts(const MarketStore& store, const std::vector<CurveId>& curves, const std::vector<Date>& dates, std::vector<double>& out) {
+            for (size_t j = 0; j < curves.size(); ++j) out[j] = store.getCurve(curves[j])->discount(dates[j]);
+        }
+    }  // namespace
+
+    RiskEngine::RiskEngine(const json& data, size_t nThreads) : data_(data) {
+        if (nThreads == 0) nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < nThreads; ++i) stores_.push_back(std::make_unique<MarketStore>());
+        builders_.resize(nThreads);
+
+        // the config is validated once, by the first clone; the others are built from it in trusted input mode
+        builders_.front() = std::make_unique<CurveBuilder>(data_, *stores_.front());
+        builders_.front()->build();
+        for (auto& store : stores_) store->setTrustedInput(true);
+        // the fixings lookup of an index inserts its history on first use, so it is done before the workers
+        // read them
+        for (const auto& name : stores_.front()->allIndexes()) stores_.front()->getIndex(name)->timeSeries();
+
+        // builders take the evaluation date themselves (exclusively while creating QuantLib objects, shared
+        // while bootstrapping), so the remaining clones are built concurrently
+        if (nThreads == 1) return;
+        utils::ThreadPool pool(nThreads - 1);
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 1; i < nThreads; ++i) {
+            tasks.push_back(pool.submit([this, i]() {
+                builders_[i] = std::make_unique<CurveBuilder>(data_, *stores_[i]);
+                builders_[i]->build();
+            }));
+        }
+        utils::waitAll(tasks);
+    }
+
+    size_t RiskEngine::workers() const {
+        return stores_.size();
+    }
+
+    Matrix RiskEngine::discountSensitivities(const std::vector<std::string>& tickers,
+                                             const std::vector<std::string>& curves,
+                                             const std::vector<Date>& dates,
+                                             double bump) {
+        if (curves.size() != dates.size()) throw std::runtime_error("Curves and dates must have the same size");
+        for (const auto& ticker : tickers)
+            if (!stores_.front()->hasQuote(ticker)) throw std::runtime_error("No quote found for " + ticker);
+
+        std::vector<double> base(dates.size());
+        discounts(*stores_.front(), curveIds(*stores_.front(), curves), dates, base);
+
+        Matrix sensitivities(tickers.size(), dates.size());
+        std::atomic<size_t> next = 0;
+        size_t nWorkers          = std::min(stores_.size(), tickers.size());
+        utils::ThreadPool pool(nWorkers);
+        std::vector<std::future<void>> tasks;
+        for (size_t w = 0; w < nWorkers; ++w) {
+            tasks.push_back(pool.submit([&, w]() {
+                MarketStore& store       = *stores_[w];
+                CurveBuilder& builder    = *builders_[w];
+                std::vector<CurveId> ids = curveIds(store, curves);
+                std::vector<double> bumped(dates.size());
+                for (size_t i = next++; i < tickers.size(); i = next++) {
+                    QuoteId quote = store.quoteId(tickers[i]);
+                    double value  = store.getQuote(quote)->value();
+                    builder.updateQuotes({quote}, {value + bump});
+                    discounts(store, ids, dates, bumped);
+                    builder.updateQuotes({quote}, {value});
+                    for (size_t j = 0; j < dates.size(); ++j) sensitivities[i][j] = (bumped[j] - base[j]) / bump;
+                }
+            }));
+        }
+        utils::waitAll(tasks);
+        return sensitivities;
+    }
+}  // namespace CurveManager
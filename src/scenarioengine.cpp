@@ -0,0 +1,197 @@
+#include <curvemanager/marketstore.hpp>
+#include <curvemanager/ratekernels.hpp>
+#include <curvemanager/scenarioengine.hpp>
+#include <ql/interestrate.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace CurveManager
+{
+    namespace
+    {
+        CompiledCurve compile(const MarketStore& marketStore, const std::string& name) {
+            const BootstrappedCurve& piecewise = marketStore.getBootstrappedCurve(name);
+            if (piecewise) return CompiledCurve(piecewise);
+            return CompiledCurve(marketStore.getCurve(name));
+        }
+
+        std::vector<Time> pillarTimes(const CompiledCurve& curve, const std::vector<Period>& pillars) {
+            std::vector<Time> times;
+            times.reserve(pillars.size());
+            for (const auto& pillar : pillars) times.push_back(curve.timeFromReference(curve.referenceDate() + pillar));
+            return times;
+        }
+    }  // namespace
+
+    SpreadType parseSpreadType(const std::string& name) {
+        if (name == "ZERO") return SpreadType::Zero;
+        if (name == "FORWARD") return SpreadType::Forward;
+        throw std::runtime_error("Unknown spread type " + name + " (expected ZERO or FORWARD)");
+    }
+
+    ScenarioEngine::ScenarioEngine(CompiledCurve curve, std::vector<Time> pillars, SpreadType type)
+    : curve_(std::move(curve)), pillars_(std::move(pillars)), type_(type) {
+        checkPillars();
+    }
+
+    ScenarioEngine::ScenarioEngine(CompiledCurve curve, const std::vector<Period>& pillars, SpreadType type)
+    : curve_(std::move(curve)), pillars_(pillarTimes(curve_, pillars)), type_(type) {
+        checkPillars();
+    }
+
+    ScenarioEngine::ScenarioEngine(const MarketStore& marketStore, const std::string& curve, std::vector<Time> pillars, SpreadType type)
+    : curve_(compile(marketStore, curve)), pillars_(std::move(pillars)), type_(type) {
+        checkPillars();
+    }
+
+    void ScenarioEngine::checkPillars() const {
+        if (pillars_.empty()) throw std::runtime_error("A scenario engine needs at least one pillar");
+        for (size_t i = 1; i < pillars_.size(); ++i)
+            if (!(pillars_[i] > pillars_[i - 1])) throw std::runtime_error("Scenario pillars must be strictly increasing");
+    }
+
+    std::vector<double> ScenarioEngine::parallel(double shift) const {
+        return std::vector<double>(pillars_.size(), shift);
+    }
+
+    std::vector<double> ScenarioEngine::keyRate(size_t pillar, double bump) const {
+        if (pillar >= pillars_.size()) throw std::runtime_error("Key rate pillar out of range");
+        std::vector<double> spreads(pillars_.size(), 0.0);
+        spreads[pillar] = bump;
+        return spreads;
+    }
+
+    std::vector<double> ScenarioEngine::twist(double shortShift, double longShift) const {
+        std::vector<double> spreads(pillars_.size(), shortShift);
+        double span = pillars_.back() - pillars_.front();
+        for (size_t i = 1; i < pillars_.size(); ++i) spreads[i] = shortShift + (longShift - shortShift) * (pillars_[i] - pillars_.front()) / span;
+        return spreads;
+    }
+
+    ScenarioEngine::Layout ScenarioEngine::layout(const Time* times, size_t n) const {
+        const size_t k  = pillars_.size();
+        const Time* x   = pillars_.data();
+        const bool zero = type_ == SpreadType::Zero;
+
+        Layout result;
+        result.base.assign(n, 0);
+        result.lower.resize(n);
+        result.upper.resize(n);
+        result.lowerWeight.resize(n);
+        result.upperWeight.resize(n);
+        result.logDiscounts.resize(n);
+        curve_.discounts(times, n, result.logDiscounts.data());
+
+        for (size_t j = 0; j < n; ++j) {
+            Time t                 = times[j];
+            result.logDiscounts[j] = std::log(result.logDiscounts[j]);
+            size_t i               = std::upper_bound(x, x + k, t) - x;
+            if (i == 0 || i == k) {
+                // flat spread outside the pillars
+                uint32_t pillar       = static_cast<uint32_t>(i == 0 ? 0 : k - 1);
+                result.lower[j]       = pillar;
+                result.upper[j]       = pillar;
+                result.lowerWeight[j] = zero || i == 0 ? t : t - x[k - 1];
+                result.upperWeight[j] = 0.0;
+                if (!zero && i == k) result.base[j] = static_cast<uint32_t>(k);
+                continue;
+            }
+            Time h          = x[i] - x[i - 1];
+            Time d          = t - x[i - 1];
+            result.lower[j] = static_cast<uint32_t>(i - 1);
+            result.upper[j] = static_cast<uint32_t>(i);
+            if (zero) {
+                result.lowerWeight[j] = t * (h - d) / h;
+                result.upperWeight[j] = t * d / h;
+            }
+            else {
+                // integral over the segment of the linear forward spread
+                result.base[j]        = static_cast<uint32_t>(i);
+                result.lowerWeight[j] = d - d * d / (2.0 * h);
+                result.upperWeight[j] = d * d / (2.0 * h);
+            }
+        }
+        return result;
+    }
+
+    void ScenarioEngine::discounts(const double* spreads, size_t nScenarios, const Time* times, size_t n, double* out) const {
+        const size_t k = pillars_.size();
+        const Layout l = layout(times, n);
+
+        // cumulative[i + 1] is the integral of the forward spread up to pillar i; all zero for zero spreads
+        std::vector<double> cumulative(k + 1, 0.0);
+        for (size_t s = 0; s < nScenarios; ++s) {
+            const double* spread = spreads + s * k;
+            if (type_ == SpreadType::Forward) {
+                cumulative[1] = spread[0] * pillars_[0];
+                for (size_t i = 1; i < k; ++i)
+                    cumulative[i + 1] = cumulative[i] + (pillars_[i] - pillars_[i - 1]) * (spread[i - 1] + spread[i]) / 2.0;
+            }
+            double* row = out + s * n;
+            for (size_t j = 0; j < n; ++j) {
+                double logSpread = cumulative[l.base[j]] + spread[l.lower[j]] * l.lowerWeight[j] + spread[l.upper[j]] * l.upperWeight[j];
+                row[j]           = std::exp(l.logDiscounts[j] - logSpread);
+            }
+        }
+    }
+
+    void ScenarioEngine::discounts(const double* spreads, size_t nScenarios, const Date::serial_type* dates, size_t n, double* out) const {
+        std::vector<Time> times(n);
+        for (size_t j = 0; j < n; ++j) times[j] = curve_.timeFromReference(Date(dates[j]));
+        discounts(spreads, nScenarios, times.data(), n, out);
+    }
+
+    void ScenarioEngine::zeroRates(const double* spreads,
+                                   size_t nScenarios,
+                                   const Date::serial_type* dates,
+                                   size_t n,
+                                   const DayCounter& dayCounter,
+                                   Compounding comp,
+                                   Frequency freq,
+                                   double* out) const {
+        const Date& refDate = curve_.referenceDate();
+        std::vector<Time> curveTimes(n), times(n);
+        for (size_t j = 0; j < n; ++j) {
+            Date date = Date(dates[j]);
+            if (date == refDate) {
+                // same convention as YieldTermStructure::zeroRate at the reference date
+                curveTimes[j] = 0.0001;
+                times[j]      = 0.0001;
+            }
+            else {
+                curveTimes[j] = curve_.timeFromReference(date);
+                times[j]      = dayCounter.yearFraction(refDate, date);
+            }
+        }
+        discounts(spreads, nScenarios, curveTimes.data(), n, out);
+
+        std::vector<double> dfs(n);
+        for (size_t s = 0; s < nScenarios; ++s) {
+            double* row = out + s * n;
+            std::copy(row, row + n, dfs.begin());
+            if (!zeroRatesFromDiscounts(dfs.data(), times.data(), n, comp, freq, row)) {
+                for (size_t j = 0; j < n; ++j) row[j] = InterestRate::impliedRate(1.0 / dfs[j], dayCounter, comp, freq, times[j]).rate();
+            }
+        }
+    }
+
+    Matrix ScenarioEngine::discounts(const Matrix& spreads, const std::vector<Date::serial_type>& dates) const {
+        if (spreads.columns() != pillars_.size()) throw std::runtime_error("Scenario spreads must have one column per pillar");
+        Matrix result(spreads.rows(), dates.size());
+        if (spreads.rows() > 0 && !dates.empty()) discounts(spreads.begin(), spreads.rows(), dates.data(), dates.size(), result.begin());
+        return result;
+    }
+
+    Matrix ScenarioEngine::zeroRates(const Matrix& spreads,
+                                     const std::vector<Date::serial_type>& dates,
+                                     const DayCounter& dayCounter,
+                                     Compounding comp,
+                                     Frequency freq) const {
+        if (spreads.columns() != pillars_.size()) throw std::runtime_error("Scenario spreads must have one column per pillar");
+        Matrix result(spreads.rows(), dates.size());
+        if (spreads.rows() > 0 && !dates.empty())
+            zeroRates(spreads.begin(), spreads.rows(), dates.data(), dates.size(), dayCounter, comp, freq, result.begin());
+        return result;
+    }
+}  // namespace CurveManager
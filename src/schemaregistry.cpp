@@ -0,0 +1,21 @@
+#include <curvemanager/schemaregistry.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace CurveManager
+{
+    const json_validator& cachedValidator(const std::string& key, const json& schema) {
+        static std::mutex mutex;
+        static std::unordered_map<std::string, std::unique_ptr<json_validator>> validators;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& validator = validators[key];
+        if (!validator) {
+            auto compiled = std::make_unique<json_validator>();
+            compiled->set_root_schema(schema);
+            validator = std::move(compiled);
+        }
+        return *validator;
+    }
+}  // namespace CurveManager
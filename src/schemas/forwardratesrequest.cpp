@@ -27,7 +27,8 @@ namespace QuantLibParser
             "type": "array",
             "items": {
                 "type": "array",
-                "maxItems": 2                
+                "minItems": 2,
+                "maxItems": 2
             }
         })"_json;
         dates["items"]["items"]     = dateSchema;
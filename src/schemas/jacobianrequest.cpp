@@ -0,0 +1,27 @@
+#include <curvemanager/schemas/jacobianrequest.hpp>
+#include <qlp/schemas/commonschemas.hpp>
+
+namespace QuantLibParser
+{
+    template <>
+    void Schema<JacobianRequest>::initSchema() {
+        json base = R"({
+            "title": "Jacobian Request Schema",
+            "type": "object",
+            "properties": {
+                "CURVE": {
+                    "type": "string"
+                }
+            },
+            "required": ["CURVE"]
+        })"_json;
+
+        base["properties"]["REFDATE"] = dateSchema;
+
+        mySchema_ = base;
+    };
+
+    template <>
+    void Schema<JacobianRequest>::initDefaultValues(){};
+
+}  // namespace QuantLibParser
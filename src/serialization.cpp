@@ -0,0 +1,226 @@
+#include <curvemanager/curvemanager.hpp>
+#include <curvemanager/curvesnapshot.hpp>
+#include <ql/termstructures/yield/discountcurve.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <qlp/parser.hpp>
+#include "utils/binaryio.hpp"
+#include "utils/mappedfile.hpp"
+
+namespace CurveManager
+{
+    using namespace QuantLibParser;
+
+    namespace
+    {
+        const uint64_t storeMagic   = 0x45524f5453524d43;  // "CMRSTORE"
+        const uint32_t storeVersion = 2;
+
+        // how a saved curve is rebuilt
+        enum class SavedCurve : uint8_t
+        {
+            Nodes,        // log-linear discount curve over its nodes
+            FlatForward,  // flat forward from its config parameters
+            Piecewise     // interpolated curve over the nodes of a piecewise curve, with its traits and interpolator
+        };
+
+        template <typename Curve>
+        void curveNodes(const Curve& curve, std::vector<Date::serial_type>& dates, std::vector<double>& values) {
+            for (const auto& date : curve.dates()) dates.push_back(date.serialNumber());
+            values = curve.data();
+        }
+    }  // namespace
+
+    bool curveNodes(const MarketStore& store, const std::string& name, std::vector<Date::serial_type>& dates, std::vector<double>& values) {
+        if (const BootstrappedCurve& piecewise = store.getBootstrappedCurve(name)) {
+            for (const auto& date : piecewise.dates()) dates.push_back(date.serialNumber());
+            values = piecewise.nodeDiscounts();
+            return true;
+        }
+        auto curve = store.getCurve(name);
+        if (auto discount = boost::dynamic_pointer_cast<DiscountCurve>(curve)) {
+            curveNodes(*discount, dates, values);
+        }
+        else if (auto flat = boost::dynamic_pointer_cast<FlatForward>(curve); flat && CompiledCurve::isLogLinear(curve)) {
+            // two nodes reproduce the curve only when its log discount is linear in t
+            Date refDate = curve->referenceDate();
+            Date endDate = refDate + Period(1, Years);
+            dates        = {refDate.serialNumber(), endDate.serialNumber()};
+            values       = {1.0, curve->discount(endDate, true)};
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    void CurveBuilder::save(const std::string& path) const {
+        utils::BinaryWriter writer(path);
+        writer.write<uint64_t>(storeMagic);
+        writer.write<uint32_t>(storeVersion);
+        writer.write<int64_t>(refDate_.serialNumber());
+
+        std::vector<std::string> curves;
+        for (const auto& name : marketStore_.allCurves())
+            if (curveConfigs_.find(name) != curveConfigs_.end()) curves.push_back(name);
+
+        writer.write<uint32_t>(static_cast<uint32_t>(curves.size()));
+        for (const auto& name : curves) {
+            auto curve                         = marketStore_.getCurve(name);
+            const BootstrappedCurve& piecewise = marketStore_.getBootstrappedCurve(name);
+            const json& config                 = curveConfigs_.at(name);
+            writer.writeString(name);
+            writer.writeString(config.at("DAYCOUNTER"));
+            writer.write<uint8_t>(curve->allowsExtrapolation());
+
+            // flat forwards keep their own parameters, which no set of log-linear nodes reproduces for simple rates
+            if (boost::dynamic_pointer_cast<FlatForward>(curve)) {
+                writer.write<uint8_t>(static_cast<uint8_t>(SavedCurve::FlatForward));
+                writer.write<double>(config.at("RATE").get<double>());
+                writer.writeString(config.at("COMPOUNDING"));
+                writer.writeString(config.at("FREQUENCY"));
+                continue;
+            }
+
+            // piecewise curves keep their traits and interpolator, so that their nodes reproduce them
+            if (piecewise) {
+                std::vector<int64_t> dates;
+                for (const auto& date : piecewise.dates()) dates.push_back(date.serialNumber());
+                writer.write<uint8_t>(static_cast<uint8_t>(SavedCurve::Piecewise));
+                writer.writeString(piecewise.traits());
+                writer.writeString(piecewise.interpolation());
+                writer.writeArray(dates);
+                writer.writeArray(piecewise.data());
+                continue;
+            }
+
+            // the other curves are restored as log-linear discount curves over their nodes
+            std::vector<Date::serial_type> dates;
+            std::vector<double> values;
+            if (!curveNodes(marketStore_, name, dates, values))
+                throw std::runtime_error("Curve type not supported by save: " + name);
+            writer.write<uint8_t>(static_cast<uint8_t>(SavedCurve::Nodes));
+            writer.writeArray(std::vector<int64_t>(dates.begin(), dates.end()));
+            writer.writeArray(values);
+        }
+
+        auto tickers = marketStore_.allQuotes();
+        writer.write<uint32_t>(static_cast<uint32_t>(tickers.size()));
+        for (const auto& ticker : tickers) {
+            writer.writeString(ticker);
+            writer.write<double>(marketStore_.getQuote(ticker)->value());
+        }
+
+        auto indexes = marketStore_.allIndexes();
+        writer.write<uint32_t>(static_cast<uint32_t>(indexes.size()));
+        for (const auto& name : indexes) {
+            std::vector<int64_t> dates;
+            std::vector<double> values;
+            for (const auto& [date, value] : marketStore_.getIndex(name)->timeSeries()) {
+                dates.push_back(date.serialNumber());
+                values.push_back(value);
+            }
+            writer.writeString(name);
+            writer.writeArray(dates);
+            writer.writeArray(values);
+        }
+        writer.close();
+    }
+
+    void CurveBuilder::restore(const std::string& path) {
+        utils::MappedFile file(path);
+        utils::BinaryReader reader(file.data(), file.size());
+        if (reader.read<uint64_t>() != storeMagic) throw std::runtime_error("Not a curve store file: " + path);
+        if (reader.read<uint32_t>() != storeVersion) throw std::runtime_error("Unsupported curve store version: " + path);
+        refDate_ = Date(static_cast<Date::serial_type>(reader.read<int64_t>()));
+        EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+
+        uint32_t nCurves = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < nCurves; ++i) {
+            std::string name         = reader.readString();
+            DayCounter dayCounter    = parse<DayCounter>(reader.readString());
+            bool enableExtrapolation = reader.read<uint8_t>() != 0;
+            auto kind                = static_cast<SavedCurve>(reader.read<uint8_t>());
+
+            boost::shared_ptr<YieldTermStructure> curvePtr;
+            if (kind == SavedCurve::FlatForward) {
+                double rate             = reader.read<double>();
+                Compounding compounding = parse<Compounding>(reader.readString());
+                Frequency frequency     = parse<Frequency>(reader.readString());
+                curvePtr.reset(new FlatForward(refDate_, rate, dayCounter, compounding, frequency));
+            }
+            else if (kind == SavedCurve::Nodes) {
+                std::vector<int64_t> serials = reader.readArray<int64_t>();
+                std::vector<double> values   = reader.readArray<double>();
+                std::vector<Date> dates;
+                dates.reserve(serials.size());
+                for (auto serial : serials) dates.push_back(Date(static_cast<Date::serial_type>(serial)));
+                curvePtr.reset(new DiscountCurve(dates, values, dayCounter));
+            }
+            else if (kind == SavedCurve::Piecewise) {
+                std::string traits           = reader.readString();
+                std::string interpolation    = reader.readString();
+                std::vector<int64_t> serials = reader.readArray<int64_t>();
+                std::vector<double> values   = reader.readArray<double>();
+                std::vector<Date> dates;
+                dates.reserve(serials.size());
+                for (auto serial : serials) dates.push_back(Date(static_cast<Date::serial_type>(serial)));
+                // the interpolated curve of BootstrappedCurve::nodeCopy
+                dispatchByName(PiecewiseTraits(), traits, [&](auto traitsTag) {
+                    dispatchByName(PiecewiseInterpolators(), interpolation, [&](auto interpolatorTag) {
+                        using Interpolator = typename decltype(interpolatorTag)::type;
+                        using Curve        = typename decltype(traitsTag)::type::template curve<Interpolator>::type;
+                        curvePtr.reset(new Curve(dates, values, dayCounter));
+                    });
+                });
+                if (!curvePtr) throw std::runtime_error("Corrupt curve store file: " + path);
+            }
+            else {
+                throw std::runtime_error("Corrupt curve store file: " + path);
+            }
+            if (enableExtrapolation) curvePtr->enableExtrapolation();
+
+            if (!marketStore_.hasCurveHandle(name)) {
+                RelinkableHandle<YieldTermStructure> handle;
+                marketStore_.addCurveHandle(name, handle);
+            }
+            marketStore_.getCurveHandle(name).linkTo(curvePtr);
+            marketStore_.addCurve(name, curvePtr);
+        }
+
+        uint32_t nQuotes = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < nQuotes; ++i) {
+            std::string ticker = reader.readString();
+            double value       = reader.read<double>();
+            if (marketStore_.hasQuote(ticker)) {
+                boost::static_pointer_cast<SimpleQuote>(marketStore_.getQuote(ticker).currentLink())->setValue(value);
+            }
+            else {
+                Handle<Quote> handle(boost::shared_ptr<Quote>(makeStoreQuote(value)));
+                marketStore_.addQuote(ticker, handle);
+            }
+        }
+
+        uint32_t nIndexes = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < nIndexes; ++i) {
+            std::string name             = reader.readString();
+            std::vector<int64_t> serials = reader.readArray<int64_t>();
+            std::vector<double> values   = reader.readArray<double>();
+            if (!marketStore_.hasIndex(name) || serials.empty()) continue;
+
+            std::vector<Date> dates;
+            dates.reserve(serials.size());
+            for (auto serial : serials) dates.push_back(Date(static_cast<Date::serial_type>(serial)));
+            marketStore_.addFixings(name, dates, values);
+        }
+        // a file with something after the fixings was cut or concatenated
+        if (!reader.atEnd()) throw std::runtime_error("Corrupt curve store file: " + path);
+        if (marketStore_.isVersioned()) marketStore_.publishSnapshot();
+    }
+
+    void CurveBuilder::rebootstrap() {
+        // dropping the curves unregisters them from shared observables
+        EvaluationDateLock lock(refDate_, EvaluationDateLock::Mode::Exclusive);
+        for (const auto& [name, curve] : curveConfigs_) marketStore_.removeCurve(name);
+        build();
+    }
+}  // namespace CurveManager
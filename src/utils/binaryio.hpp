@@ -0,0 +1,100 @@
+#ifndef B524E959_7017_43E5_B64D_C68346C4C107
+#define B524E959_7017_43E5_B64D_C68346C4C107
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace utils
+{
+    /*
+     * Minimal little endian binary writer/reader for trivially copyable values, length prefixed strings
+     * and arrays. Only little endian hosts are supported.
+     */
+    class BinaryWriter {
+       public:
+        explicit BinaryWriter(const std::string& path) : file_(path, std::ios::binary | std::ios::trunc) {
+            if constexpr (std::endian::native != std::endian::little) throw std::runtime_error("Binary files require a little endian host");
+            if (!file_) throw std::runtime_error("Could not open file: " + path);
+        };
+
+        template <typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            file_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        };
+
+        template <typename T>
+        void writeArray(const std::vector<T>& values) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            write<uint64_t>(values.size());
+            file_.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        };
+
+        void writeString(const std::string& value) {
+            write<uint32_t>(static_cast<uint32_t>(value.size()));
+            file_.write(value.data(), value.size());
+        };
+
+        void close() {
+            file_.close();
+            if (!file_) throw std::runtime_error("Error writing binary file");
+        };
+
+       private:
+        std::ofstream file_;
+    };
+
+    class BinaryReader {
+       public:
+        BinaryReader(const char* data, size_t size) : data_(data), size_(size) {
+            if constexpr (std::endian::native != std::endian::little) throw std::runtime_error("Binary files require a little endian host");
+        };
+
+        template <typename T>
+        T read() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            std::memcpy(&value, advance(sizeof(T)), sizeof(T));
+            return value;
+        };
+
+        template <typename T>
+        std::vector<T> readArray() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            uint64_t n = read<uint64_t>();
+            if (n > (size_ - offset_) / sizeof(T)) throw std::runtime_error("Corrupt binary file: array out of bounds");
+            std::vector<T> values(n);
+            if (n > 0) std::memcpy(values.data(), advance(n * sizeof(T)), n * sizeof(T));
+            return values;
+        };
+
+        std::string readString() {
+            uint32_t n = read<uint32_t>();
+            return std::string(advance(n), n);
+        };
+
+        bool atEnd() const {
+            return offset_ == size_;
+        };
+
+       private:
+        const char* advance(size_t n) {
+            if (n > size_ - offset_) throw std::runtime_error("Corrupt binary file: unexpected end of data");
+            const char* current = data_ + offset_;
+            offset_ += n;
+            return current;
+        };
+
+        const char* data_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+}  // namespace utils
+
+#endif /* B524E959_7017_43E5_B64D_C68346C4C107 */
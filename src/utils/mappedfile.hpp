@@ -0,0 +1,77 @@
+#ifndef AF06948C_EE1A_4683_B358_2770763306FB
+#define AF06948C_EE1A_4683_B358_2770763306FB
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <fstream>
+    #include <iterator>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace utils
+{
+    /*
+     * Read only view of a whole file. The file is memory mapped on POSIX systems and read into a buffer
+     * elsewhere.
+     */
+    class MappedFile {
+       public:
+        explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+            std::ifstream file(path, std::ios::binary);
+            if (!file) throw std::runtime_error("Could not open file: " + path);
+            buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Could not open file: " + path);
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Could not read file size: " + path);
+            }
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_ > 0) {
+                void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Could not map file: " + path);
+                }
+                data_ = static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+#endif
+        };
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+        };
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const {
+            return data_;
+        };
+        size_t size() const {
+            return size_;
+        };
+
+       private:
+        const char* data_ = nullptr;
+        size_t size_      = 0;
+        std::vector<char> buffer_;
+    };
+}  // namespace utils
+
+#endif /* AF06948C_EE1A_4683_B358_2770763306FB */
@@ -0,0 +1,96 @@
+#ifndef E7F8C66B_C4E0_4184_A50F_77F9BB35E483
+#define E7F8C66B_C4E0_4184_A50F_77F9BB35E483
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+    /*
+     * Fixed size pool of worker threads. Tasks are run in submission order; the returned future
+     * rethrows any exception raised by the task.
+     */
+    class ThreadPool {
+       public:
+        explicit ThreadPool(size_t nThreads = 0) {
+            if (nThreads == 0) nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            workers_.reserve(nThreads);
+            for (size_t i = 0; i < nThreads; ++i) workers_.emplace_back([this]() { work(); });
+        };
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            condition_.notify_all();
+            for (auto& worker : workers_) worker.join();
+        };
+
+        ThreadPool(const ThreadPool&)            = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template <typename F>
+        std::future<void> submit(F&& f) {
+            auto task                = std::make_shared<std::packaged_task<void()>>(std::forward<F>(f));
+            std::future<void> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push([task]() { (*task)(); });
+            }
+            condition_.notify_one();
+            return result;
+        };
+
+        size_t size() const {
+            return workers_.size();
+        };
+
+       private:
+        void work() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    condition_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                    if (stop_ && tasks_.empty()) return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                }
+                task();
+            }
+        };
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stop_ = false;
+    };
+
+    /*
+     * Waits for every future and rethrows the first exception found, so that no task is still
+     * running (and referencing the caller's data) when the error propagates.
+     */
+    inline void waitAll(std::vector<std::future<void>>& futures) {
+        std::exception_ptr error;
+        for (auto& future : futures) {
+            try {
+                future.get();
+            }
+            catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    };
+}  // namespace utils
+
+#endif /* E7F8C66B_C4E0_4184_A50F_77F9BB35E483 */
@@ -5,9 +5,26 @@
  */
 
 #include <curvemanager/curvemanager.hpp>
+#include <curvemanager/curvesnapshot.hpp>
+#include <curvemanager/dateparser.hpp>
+#include <curvemanager/encoding.hpp>
+#include <curvemanager/historyengine.hpp>
+#include <curvemanager/quotequeue.hpp>
+#include <curvemanager/ratekernels.hpp>
+#include <curvemanager/riskengine.hpp>
+#include <curvemanager/scenarioengine.hpp>
+#include <curvemanager/schemaregistry.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/termstructures/yield/zerocurve.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <qlp/parser.hpp>
+#include <qlp/schemas/termstructures/all.hpp>
 #include "pch.hpp"
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <thread>
 
 using namespace CurveManager;
 
@@ -43,6 +60,101 @@ TEST(CurveManager, PiecewiseCurveFullBuild2) {
     EXPECT_NO_THROW(builder.build());
 }
 
+TEST(CurveManager, PiecewiseCurveFullParallelBuild) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore serialStore;
+    CurveBuilder serialBuilder(curveData, serialStore);
+    serialBuilder.build();
+
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    EXPECT_NO_THROW(builder.buildParallel(4));
+    EXPECT_EQ(builder.buildTimes().size(), store.allCurves().size());
+
+    Date date = Settings::instance().evaluationDate() + Period(5, Years);
+    for (const auto& name : store.allCurves()) {
+        EXPECT_NEAR(store.getCurve(name)->discount(date), serialStore.getCurve(name)->discount(date), 1e-12);
+    }
+}
+
+TEST(CurveManager, ParallelConfigLoading) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore serialStore;
+    CurveBuilder serialBuilder(curveData, serialStore);
+    serialBuilder.build();
+
+    // parsed in place from the file and moved into the builder
+    MarketStore store;
+    CurveBuilder builder(readCurveConfig("json/piecewisefull.json"), store, 4);
+    EXPECT_NO_THROW(builder.build());
+    EXPECT_GE(builder.configLoadTimes().validateMs, 0.0);
+    EXPECT_GE(builder.configLoadTimes().preprocessMs, 0.0);
+
+    Date date = Settings::instance().evaluationDate() + Period(5, Years);
+    ASSERT_EQ(store.allCurves().size(), serialStore.allCurves().size());
+    for (const auto& name : store.allCurves()) {
+        EXPECT_NEAR(store.getCurve(name)->discount(date), serialStore.getCurve(name)->discount(date), 1e-12);
+    }
+
+    std::ifstream file("json/piecewisefull.json");
+    EXPECT_EQ(readCurveConfig(file), curveData);
+
+    // an invalid block is reported from the workers
+    json config                 = curveData;
+    config["CURVES"][0]["TYPE"] = "SPLINE";
+    MarketStore invalidStore;
+    EXPECT_ANY_THROW(CurveBuilder invalidBuilder(std::move(config), invalidStore, 4));
+}
+
+TEST(CurveManager, ConfigDefaults) {
+    // a field left out of a curve block takes the default of its schema, as if it had been written
+    std::vector<std::pair<std::string, json>> configs = {
+        {"json/discount.json", cachedSchema<DiscountCurve>().setDefaultValues(json::object())},
+        {"json/flatforward.json", cachedSchema<FlatForward>().setDefaultValues(json::object())},
+        {"json/piecewise.json", cachedSchema<QuantLibParser::BootstrapCurve>().setDefaultValues(json::object())}};
+    size_t checked = 0;
+    for (const auto& [path, defaults] : configs) {
+        json curveData = readJSONFile(path);
+        for (auto it = defaults.begin(); it != defaults.end(); ++it) {
+            if (!curveData["CURVES"][0].contains(it.key())) continue;
+            json written                   = curveData;
+            written["CURVES"][0][it.key()] = it.value();
+            json omitted                   = curveData;
+            omitted["CURVES"][0].erase(it.key());
+
+            MarketStore writtenStore, omittedStore;
+            CurveBuilder writtenBuilder(written, writtenStore);
+            writtenBuilder.build();
+            CurveBuilder omittedBuilder(omitted, omittedStore);
+            ASSERT_NO_THROW(omittedBuilder.build()) << path << " without " << it.key();
+
+            const std::string& name = curveData["CURVES"][0]["NAME"];
+            auto expected           = writtenStore.getCurve(name);
+            auto curve              = omittedStore.getCurve(name);
+            EXPECT_EQ(curve->allowsExtrapolation(), expected->allowsExtrapolation()) << path << " without " << it.key();
+            Date date = expected->referenceDate() + Period(6, Months);
+            EXPECT_NEAR(curve->discount(date), expected->discount(date), 1e-12) << path << " without " << it.key();
+            ++checked;
+        }
+    }
+    EXPECT_GT(checked, size_t(0));
+}
+
+TEST(CurveManager, BuildWaves) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    auto waves = builder.buildWaves();
+
+    std::set<std::string> built;
+    for (const auto& wave : waves) {
+        for (const auto& name : wave)
+            for (const auto& dependency : builder.curveDependencies(name)) EXPECT_TRUE(built.find(dependency) != built.end());
+        built.insert(wave.begin(), wave.end());
+    }
+    EXPECT_EQ(built.size(), size_t(11));
+}
+
 TEST(CurveManager, FlatForwardCurveBuild) {
     json curveData = readJSONFile("json/flatforward.json");
     MarketStore store;
@@ -75,6 +187,59 @@ TEST(CurveManager, BootstrapResults) {
     EXPECT_NO_THROW(store.bootstrapResults(););
 }
 
+TEST(CurveManager, PiecewiseInterpolations) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore baseStore;
+    CurveBuilder baseBuilder(curveData, baseStore);
+    baseBuilder.build();
+    Date date = baseBuilder.referenceDate() + 10 * Years;
+
+    for (const auto& traits : configNames(PiecewiseTraits())) {
+        for (const auto& interpolation : configNames(PiecewiseInterpolators())) {
+            json config = curveData;
+            for (auto& curve : config["CURVES"]) {
+                curve["TRAITS"]        = traits;
+                curve["INTERPOLATION"] = interpolation;
+            }
+            MarketStore store;
+            store.setVersioned(true);
+            CurveBuilder builder(config, store);
+            ASSERT_NO_THROW(builder.build()) << traits << "/" << interpolation;
+
+            const auto& curve = store.getBootstrappedCurve("SOFR");
+            ASSERT_TRUE(curve);
+            EXPECT_EQ(curve.traits(), traits);
+            EXPECT_EQ(curve.interpolation(), interpolation);
+            EXPECT_NEAR(store.getCurve("SOFR")->discount(date), baseStore.getCurve("SOFR")->discount(date), 1e-3);
+
+            // every combination is in the snapshot, as nodes or as a frozen copy of the curve
+            ASSERT_TRUE(store.snapshot()->hasCurve("SOFR"));
+            EXPECT_EQ(store.snapshot()->curve("SOFR").isFrozenCopy(), !curve.isLogLinearDiscount());
+            Date::serial_type serial = date.serialNumber();
+            double versioned         = 0.0;
+            store.discounts("SOFR", &serial, 1, &versioned);
+            EXPECT_NEAR(versioned, store.getCurve("SOFR")->discount(date), 1e-12);
+
+            // quote updates go through the erased freeze and recalculate, and leave the pinned epoch unchanged
+            EpochHandle pinned = store.pin();
+            double before      = store.getCurve("SOFR")->discount(date);
+            json prices        = json::array();
+            for (const auto& ticker : store.allQuotes()) prices.push_back({{"NAME", ticker}, {"VALUE", store.getQuote(ticker)->value() + 0.0001}});
+            EXPECT_FALSE(builder.updateQuotes(prices).empty());
+            EXPECT_LT(store.getCurve("SOFR")->discount(date), before);
+            const CompiledCurve& old = pinned->curve("SOFR");
+            EXPECT_NEAR(old.discount(old.timeFromReference(date)), before, 1e-12);
+            store.discounts("SOFR", &serial, 1, &versioned);
+            EXPECT_NEAR(versioned, store.getCurve("SOFR")->discount(date), 1e-12);
+        }
+    }
+
+    json config                          = curveData;
+    config["CURVES"][0]["INTERPOLATION"] = "SPLINE";
+    MarketStore store;
+    EXPECT_ANY_THROW(CurveBuilder builder(config, store));
+}
+
 TEST(CurveManager, UpdateQuotes) {
     json curveData = readJSONFile("json/piecewisefull.json");
     MarketStore store;
@@ -92,6 +257,28 @@ TEST(CurveManager, UpdateQuotes) {
     EXPECT_NO_THROW(builder.updateQuotes(quoteData));
 }
 
+TEST(CurveManager, UpdateQuotesAffectedCurves) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    Date date      = Settings::instance().evaluationDate() + Period(5, Years);
+    double sofr    = store.getCurve("SOFR")->discount(date);
+    double libor1m = store.getCurve("LIBOR1M")->discount(date);
+
+    json quoteData = R"([
+		{
+	"NAME": "USBA1 BGN CURNCY",
+	"VALUE": 0.05
+		}
+	])"_json;
+
+    std::vector<std::string> recalculated = builder.updateQuotes(quoteData);
+    EXPECT_EQ(recalculated, std::vector<std::string>{"LIBOR1M"});
+    EXPECT_NE(store.getCurve("LIBOR1M")->discount(date), libor1m);
+    EXPECT_DOUBLE_EQ(store.getCurve("SOFR")->discount(date), sofr);
+}
 
 TEST(CurveManager, UpdateQuotes2) {
     json curveData = readJSONFile("json/piecewisefull2.json");
@@ -119,6 +306,24 @@ TEST(CurveManager, DiscountFactorRequests) {
     EXPECT_NO_THROW(store.discountRequest(request));
 }
 
+TEST(CurveManager, BatchDiscounts) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    std::vector<std::string> dates = {"29012026", "15062030", "28082040"};
+    json request                   = R"({"REFDATE":"28082022", "CURVE":"SOFR"})"_json;
+    request["DATES"]               = dates;
+    json response                  = store.discountRequest(request);
+
+    std::vector<Date::serial_type> serials;
+    for (const auto& date : dates) serials.push_back(QuantLibParser::parse<Date>(date).serialNumber());
+    std::vector<double> values(serials.size());
+    store.discounts("SOFR", serials.data(), serials.size(), values.data());
+    for (size_t i = 0; i < values.size(); ++i) EXPECT_DOUBLE_EQ(response[i]["VALUE"], values[i]);
+}
+
 TEST(CurveManager, ZeroRatesRequest) {
     json curveData = readJSONFile("json/discount.json");
     MarketStore store;
@@ -136,6 +341,56 @@ TEST(CurveManager, ZeroRatesRequest) {
     EXPECT_NO_THROW(store.zeroRateRequest(request));
 }
 
+TEST(CurveManager, ZeroRatesValues) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    auto curve = store.getCurve("SOFR");
+
+    std::vector<std::string> compoundings = {"SIMPLE", "COMPOUNDED", "CONTINUOUS"};
+    for (const auto& compounding : compoundings) {
+        json request = R"({
+            "REFDATE":"28082022",
+            "CURVE":"SOFR",
+            "DAYCOUNTER":"ACT360",
+            "FREQUENCY":"SEMIANNUAL",
+            "DATES":["28082022", "24022023", "28082030"]
+        })"_json;
+        request["COMPOUNDING"] = compounding;
+        json response          = store.zeroRateRequest(request);
+
+        Compounding comp = QuantLibParser::parse<Compounding>(compounding);
+        for (const auto& row : response) {
+            Date date       = QuantLibParser::parse<Date>(row["DATE"]);
+            double expected = curve->zeroRate(date, Actual360(), comp, Semiannual).rate();
+            EXPECT_NEAR(row["VALUE"], expected, 1e-12);
+        }
+    }
+
+    // the kernel leaves the inputs InterestRate rejects to QuantLib, which fails as zeroRate does
+    std::vector<Date::serial_type> dates = {Date(24, February, 2023).serialNumber(), Date(28, August, 2030).serialNumber()};
+    std::vector<double> values(dates.size());
+    for (Frequency freq : {NoFrequency, Once}) {
+        for (Compounding comp : {Compounded, SimpleThenCompounded}) {
+            EXPECT_THROW(curve->zeroRate(Date(dates[1]), Actual360(), comp, freq), std::exception);
+            EXPECT_THROW(store.zeroRates("SOFR", dates.data(), dates.size(), Actual360(), comp, freq, values.data()), std::exception);
+        }
+    }
+    std::vector<Date::serial_type> before = {(curve->referenceDate() - 30).serialNumber()};
+    EXPECT_THROW(curve->zeroRate(Date(before[0]), Actual360(), Continuous), std::exception);
+    EXPECT_THROW(store.zeroRates("SOFR", before.data(), before.size(), Actual360(), Continuous, Annual, values.data()), std::exception);
+
+    std::vector<double> dfs = {1.0, 0.99}, times = {0.0, 1.0};
+    EXPECT_FALSE(zeroRatesFromDiscounts(dfs.data(), times.data(), dfs.size(), Continuous, Annual, values.data()));
+    EXPECT_FALSE(zeroRatesFromDiscounts(dfs.data() + 1, times.data() + 1, 1, Compounded, NoFrequency, values.data()));
+
+    // the frequency does take part for the compoundings that use it
+    store.zeroRates("SOFR", dates.data(), dates.size(), Actual360(), SimpleThenCompounded, Quarterly, values.data());
+    for (size_t i = 0; i < dates.size(); ++i)
+        EXPECT_NEAR(values[i], curve->zeroRate(Date(dates[i]), Actual360(), SimpleThenCompounded, Quarterly).rate(), 1e-12);
+}
+
 TEST(CurveManager, ForwardRatesRequests) {
     json curveData = readJSONFile("json/discount.json");
     MarketStore store;
@@ -150,3 +405,793 @@ TEST(CurveManager, ForwardRatesRequests) {
 	})"_json;
     EXPECT_NO_THROW(store.forwardRateRequest(request));
 }
+
+TEST(CurveManager, CurveSnapshot) {
+    json continuous                        = readJSONFile("json/flatforward.json");
+    continuous["CURVES"][0]["COMPOUNDING"] = "CONTINUOUS";
+    json compounded                        = readJSONFile("json/flatforward.json");
+    compounded["CURVES"][0]["COMPOUNDING"] = "COMPOUNDED";
+    compounded["CURVES"][0]["FREQUENCY"]   = "SEMIANNUAL";
+    for (const json& curveData : {readJSONFile("json/piecewise.json"), readJSONFile("json/discount.json"), continuous, compounded}) {
+        MarketStore store;
+        CurveBuilder builder(curveData, store);
+        builder.build();
+        store.publishSnapshot();
+
+        auto snapshot                 = store.snapshot();
+        auto curve                    = store.getCurve("SOFR");
+        const CompiledCurve& compiled = snapshot->curve("SOFR");
+        for (const Period& tenor : {Period(0, Days), Period(3, Months), Period(2, Years), Period(10, Years), Period(60, Years)}) {
+            Date date = curve->referenceDate() + tenor;
+            EXPECT_NEAR(compiled.discount(compiled.timeFromReference(date)), curve->discount(date, true), 1e-12);
+        }
+    }
+
+    // simple rates are not log-linear in t: the curve is compiled to a frozen copy
+    json curveData = readJSONFile("json/flatforward.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    store.publishSnapshot();
+    auto curve = store.getCurve("SOFR");
+    EXPECT_FALSE(CompiledCurve::isLogLinear(curve));
+    ASSERT_TRUE(store.snapshot()->hasCurve("SOFR"));
+    auto snapshot                 = store.snapshot();
+    const CompiledCurve& compiled = snapshot->curve("SOFR");
+    EXPECT_TRUE(compiled.isFrozenCopy());
+    for (const Period& tenor : {Period(0, Days), Period(3, Months), Period(2, Years), Period(10, Years), Period(60, Years)}) {
+        Date date = curve->referenceDate() + tenor;
+        EXPECT_NEAR(compiled.discount(compiled.timeFromReference(date)), curve->discount(date, true), 1e-14);
+    }
+
+    // versioned queries on a curve no epoch can compile throw instead of reading the live curve
+    Date refDate = curve->referenceDate();
+    boost::shared_ptr<YieldTermStructure> zero(new ZeroCurve({refDate, refDate + 1 * Years}, {0.01, 0.01}, Actual360()));
+    store.addCurve("ZERO", zero);
+    store.setVersioned(true);
+    store.publishSnapshot();
+    EXPECT_FALSE(store.snapshot()->hasCurve("ZERO"));
+    Date::serial_type serial = (refDate + 6 * Months).serialNumber();
+    double value             = 0.0;
+    EXPECT_THROW(store.discounts("ZERO", &serial, 1, &value), std::runtime_error);
+}
+
+TEST(CurveManager, VersionedExtrapolation) {
+    // without extrapolation the versioned queries fail past the last node, as the live curve does
+    json curveData                                = readJSONFile("json/piecewise.json");
+    curveData["CURVES"][0]["ENABLEEXTRAPOLATION"] = false;
+    MarketStore store;
+    store.setVersioned(true);
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    auto curve = store.getCurve("SOFR");
+    ASSERT_FALSE(curve->allowsExtrapolation());
+    auto snapshot                 = store.snapshot();
+    const CompiledCurve& compiled = snapshot->curve("SOFR");
+    EXPECT_FALSE(compiled.allowsExtrapolation());
+    EXPECT_DOUBLE_EQ(compiled.maxTime(), curve->maxTime());
+
+    std::vector<Date::serial_type> inside = {(curve->maxDate() - 1).serialNumber()};
+    std::vector<Date::serial_type> past   = {(curve->maxDate() + Period(1, Years)).serialNumber()};
+    std::vector<double> values(1);
+    EXPECT_NO_THROW(store.discounts("SOFR", inside.data(), inside.size(), values.data()));
+    EXPECT_NEAR(values[0], curve->discount(Date(inside[0])), 1e-12);
+    EXPECT_THROW(curve->discount(Date(past[0])), std::exception);
+    EXPECT_THROW(store.discounts("SOFR", past.data(), past.size(), values.data()), std::exception);
+
+    json request     = R"({"REFDATE":"28082022", "CURVE":"SOFR", "DATES":[]})"_json;
+    request["DATES"] = {formatDDMMYYYY(Date(past[0]))};
+    EXPECT_THROW(store.discountRequest(request), std::exception);
+}
+
+TEST(CurveManager, CurveSnapshotConcurrentReads) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    store.publishSnapshot();
+
+    std::vector<std::thread> readers;
+    std::vector<double> results(4);
+    for (size_t i = 0; i < results.size(); ++i) {
+        readers.emplace_back([&store, &results, i]() {
+            double sum = 0.0;
+            for (size_t j = 0; j < 1000; ++j) {
+                auto snapshot = store.snapshot();
+                sum += snapshot->curve("SOFR").discount(0.01 * j);
+            }
+            results[i] = sum;
+        });
+    }
+    for (size_t i = 0; i < 10; ++i) store.publishSnapshot();
+    for (auto& reader : readers) reader.join();
+    for (double result : results) EXPECT_DOUBLE_EQ(result, results[0]);
+}
+
+TEST(CurveManager, VersionedStore) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    store.setVersioned(true);
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    EpochHandle before = store.pin();
+    Date date          = Settings::instance().evaluationDate() + Period(5, Years);
+    double libor1m     = before->curve("LIBOR1M").discount(before->curve("LIBOR1M").timeFromReference(date));
+
+    json quoteData = R"([{"NAME": "USBA1 BGN CURNCY", "VALUE": 0.05}])"_json;
+    builder.updateQuotes(quoteData);
+
+    EpochHandle after = store.pin();
+    EXPECT_EQ(after.epoch(), before.epoch() + 1);
+    EXPECT_DOUBLE_EQ(before->curve("LIBOR1M").discount(before->curve("LIBOR1M").timeFromReference(date)), libor1m);
+    EXPECT_NEAR(after->curve("LIBOR1M").discount(after->curve("LIBOR1M").timeFromReference(date)), store.getCurve("LIBOR1M")->discount(date), 1e-12);
+    // curves that did not change are shared between epochs
+    EXPECT_EQ(&before->curve("SOFR"), &after->curve("SOFR"));
+    EXPECT_NE(&before->curve("LIBOR1M"), &after->curve("LIBOR1M"));
+}
+
+TEST(CurveManager, TrustedInput) {
+    json curveData = readJSONFile("json/discount.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    // REFDATE is required by the request schema
+    json request = R"({"DATES":["29012026"], "CURVE":"SOFR"})"_json;
+    EXPECT_ANY_THROW(store.discountRequest(request));
+    store.setTrustedInput(true);
+    EXPECT_NO_THROW(store.discountRequest(request));
+}
+
+TEST(CurveManager, SaveAndRestore) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    std::string path = (std::filesystem::temp_directory_path() / "curvemanager_piecewisefull.bin").string();
+    builder.save(path);
+
+    MarketStore restoredStore;
+    CurveBuilder restoredBuilder(curveData, restoredStore);
+    EXPECT_NO_THROW(restoredBuilder.restore(path));
+    std::filesystem::remove(path);
+
+    Date date = Settings::instance().evaluationDate() + Period(7, Years);
+    for (const auto& name : store.allCurves()) {
+        EXPECT_NEAR(restoredStore.getCurve(name)->discount(date), store.getCurve(name)->discount(date), 1e-12);
+        // indexes forecast on the relinked handles
+        if (store.hasIndex(name)) EXPECT_EQ(*restoredStore.getCurveHandle(name), restoredStore.getCurve(name));
+    }
+
+    EXPECT_NO_THROW(restoredBuilder.rebootstrap());
+    for (const auto& name : store.allCurves())
+        EXPECT_NEAR(restoredStore.getCurve(name)->discount(date), store.getCurve(name)->discount(date), 1e-10);
+
+    // flat forwards come back as flat forwards: simple rates and no extrapolation needed
+    json flatData                                = readJSONFile("json/flatforward.json");
+    flatData["CURVES"][0]["ENABLEEXTRAPOLATION"] = false;
+    MarketStore flatStore;
+    CurveBuilder flatBuilder(flatData, flatStore);
+    flatBuilder.build();
+    flatBuilder.save(path);
+    MarketStore restoredFlatStore;
+    CurveBuilder restoredFlatBuilder(flatData, restoredFlatStore);
+    EXPECT_NO_THROW(restoredFlatBuilder.restore(path));
+    std::ofstream(path, std::ios::binary | std::ios::app).put('\0');
+    EXPECT_THROW(restoredFlatBuilder.restore(path), std::runtime_error);
+    std::filesystem::remove(path);
+    auto flat = flatStore.getCurve("SOFR");
+    for (const Period& tenor : {Period(3, Months), Period(1, Years), Period(10, Years)}) {
+        Date flatDate = flat->referenceDate() + tenor;
+        EXPECT_NEAR(restoredFlatStore.getCurve("SOFR")->discount(flatDate), flat->discount(flatDate), 1e-14);
+    }
+
+    // every piecewise combination comes back over its own traits and interpolator, in the versioned snapshot too
+    json piecewiseData = readJSONFile("json/piecewise.json");
+    for (const auto& traits : configNames(PiecewiseTraits())) {
+        for (const auto& interpolation : configNames(PiecewiseInterpolators())) {
+            json config = piecewiseData;
+            for (auto& curve : config["CURVES"]) {
+                curve["TRAITS"]        = traits;
+                curve["INTERPOLATION"] = interpolation;
+            }
+            MarketStore piecewiseStore;
+            CurveBuilder piecewiseBuilder(config, piecewiseStore);
+            piecewiseBuilder.build();
+            ASSERT_NO_THROW(piecewiseBuilder.save(path)) << traits << "/" << interpolation;
+
+            MarketStore restoredPiecewiseStore;
+            restoredPiecewiseStore.setVersioned(true);
+            CurveBuilder restoredPiecewiseBuilder(config, restoredPiecewiseStore);
+            ASSERT_NO_THROW(restoredPiecewiseBuilder.restore(path)) << traits << "/" << interpolation;
+            std::filesystem::remove(path);
+
+            auto curve = piecewiseStore.getCurve("SOFR");
+            std::vector<Date::serial_type> serials;
+            for (const Period& tenor : {Period(3, Months), Period(2, Years), Period(7, Years), Period(25, Years)})
+                serials.push_back((curve->referenceDate() + tenor).serialNumber());
+            std::vector<double> versioned(serials.size());
+            restoredPiecewiseStore.discounts("SOFR", serials.data(), serials.size(), versioned.data());
+            for (size_t i = 0; i < serials.size(); ++i) {
+                double expected = curve->discount(Date(serials[i]));
+                EXPECT_NEAR(restoredPiecewiseStore.getCurve("SOFR")->discount(Date(serials[i])), expected, 1e-12) << traits << "/" << interpolation;
+                EXPECT_NEAR(versioned[i], expected, 1e-12) << traits << "/" << interpolation;
+            }
+        }
+    }
+}
+
+TEST(CurveManager, Jacobian) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.setJacobianMode(true);
+    builder.build();
+
+    CurveJacobian jacobian   = store.getJacobian("SOFR");
+    const auto& curve        = store.getBootstrappedCurve("SOFR");
+    std::vector<double> base = curve.data();
+    ASSERT_EQ(jacobian.values.rows(), base.size() - 1);
+    ASSERT_EQ(jacobian.values.columns(), jacobian.tickers.size());
+
+    // the helpers are repriced on copies, which leaves the store handle and the curve alone
+    struct Notifications : public Observer {
+        size_t count = 0;
+        void update() override {
+            ++count;
+        }
+    };
+    Notifications notifications;
+    notifications.registerWith(store.getCurveHandle("SOFR"));
+    notifications.registerWith(store.getCurve("SOFR"));
+    builder.computeJacobian("SOFR");
+    EXPECT_EQ(notifications.count, 0);
+    EXPECT_EQ(curve.data(), base);
+    EXPECT_EQ(store.getJacobian("SOFR").values.rows(), jacobian.values.rows());
+
+    // compare one column against a bumped rebuild
+    const Size k      = jacobian.tickers.size() / 2;
+    const double bump = 1.0e-6;
+    json quoteData    = json::array();
+    quoteData.push_back({{"NAME", jacobian.tickers[k]}, {"VALUE", store.getQuote(jacobian.tickers[k])->value() + bump}});
+    builder.updateQuotes(quoteData);
+    std::vector<double> bumped = curve.data();
+    for (Size j = 0; j < jacobian.values.rows(); ++j) {
+        double finiteDifference = (bumped[j + 1] - base[j + 1]) / bump;
+        EXPECT_NEAR(finiteDifference, jacobian.values[j][k], 1.0e-4 * std::max(1.0, std::abs(jacobian.values[j][k])));
+    }
+
+    json request  = R"({"CURVE":"SOFR"})"_json;
+    json response = store.jacobianRequest(request);
+    EXPECT_EQ(response["JACOBIAN"].size(), jacobian.values.rows());
+}
+
+TEST(CurveManager, RiskEngine) {
+    json curveData = readJSONFile("json/piecewise.json");
+    std::vector<std::string> tickers;
+    for (const auto& helper : curveData["CURVES"][0]["RATEHELPERS"]) {
+        if (tickers.size() == 3) break;
+        tickers.push_back(helper["RATETICKER"]);
+    }
+
+    // the config is validated once, before the clones are built in trusted input mode
+    json invalid = curveData;
+    invalid.erase("REFDATE");
+    EXPECT_ANY_THROW(RiskEngine(invalid, 2));
+
+    RiskEngine engine(curveData, 3);
+    EXPECT_EQ(engine.workers(), 3u);
+    Date refDate                    = QuantLibParser::parse<Date>(curveData["REFDATE"]);
+    std::vector<Date> dates         = {refDate + Period(1, Years), refDate + Period(10, Years)};
+    std::vector<std::string> curves = {"SOFR", "SOFR"};
+    const double bump               = 1.0e-4;
+    Matrix sensitivities            = engine.discountSensitivities(tickers, curves, dates, bump);
+
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    for (size_t i = 0; i < tickers.size(); ++i) {
+        double value = store.getQuote(tickers[i])->value();
+        std::vector<double> base;
+        for (const auto& date : dates) base.push_back(store.getCurve("SOFR")->discount(date));
+        json quoteData = json::array();
+        quoteData.push_back({{"NAME", tickers[i]}, {"VALUE", value + bump}});
+        builder.updateQuotes(quoteData);
+        for (size_t j = 0; j < dates.size(); ++j)
+            EXPECT_NEAR(sensitivities[i][j], (store.getCurve("SOFR")->discount(dates[j]) - base[j]) / bump, 1e-10);
+        quoteData[0]["VALUE"] = value;
+        builder.updateQuotes(quoteData);
+    }
+}
+
+
+TEST(CurveManager, Metrics) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.buildParallel(2);
+
+    json quoteData = R"([
+		{
+	"NAME": "USBA1 BGN CURNCY",
+	"VALUE": 0.05
+		}
+	])"_json;
+    builder.updateQuotes(quoteData);
+    json request = R"({"REFDATE":"28102022", "DATES":["29012026"], "CURVE":"SOFR"})"_json;
+    store.discountRequest(request);
+    Date::serial_type date = Date(29, January, 2026).serialNumber();
+    double rate            = 0.0;
+    store.zeroRates("SOFR", &date, 1, Actual360(), Continuous, Annual, &rate);
+
+    json metrics = store.metrics();
+    EXPECT_NO_THROW(store.prometheusMetrics());
+#ifdef CURVEMANAGER_METRICS
+    EXPECT_TRUE(metrics["ENABLED"]);
+    // one sample per call, in the histogram of the endpoint called
+    EXPECT_EQ(metrics["TIMINGS"]["DISCOUNTREQUEST"]["COUNT"], 1);
+    EXPECT_EQ(metrics["TIMINGS"]["ZERORATES"]["COUNT"], 1);
+    EXPECT_EQ(metrics["TIMINGS"]["DISCOUNTS"]["COUNT"], 0);
+    EXPECT_EQ(metrics["TIMINGS"]["QUOTEUPDATE"]["COUNT"], 1);
+    EXPECT_EQ(metrics["CURVES"]["LIBOR1M"]["BOOTSTRAPS"], 2);
+    EXPECT_GT(metrics["CURVES"]["LIBOR1M"]["SOLVERITERATIONS"], 0);
+    for (const auto& curve : curveData["CURVES"])
+        if (curve["NAME"] == "LIBOR1M") EXPECT_EQ(metrics["CURVES"]["LIBOR1M"]["HELPERS"], curve["RATEHELPERS"].size());
+    EXPECT_NE(store.prometheusMetrics().find("curvemanager_curve_bootstrap_seconds{curve=\"LIBOR1M\"}"), std::string::npos);
+#else
+    EXPECT_FALSE(metrics["ENABLED"]);
+#endif
+}
+
+TEST(CurveManager, WarmStartBootstrap) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore coldStore, warmStore;
+    CurveBuilder coldBuilder(curveData, coldStore);
+    CurveBuilder warmBuilder(curveData, warmStore);
+    warmBuilder.setWarmStart(true);
+    coldBuilder.build();
+    warmBuilder.build();
+
+    // parallel one basis point bump of every quote
+    auto bump = [](MarketStore& store, CurveBuilder& builder) {
+        std::vector<QuoteId> ids;
+        std::vector<double> values;
+        for (const auto& ticker : store.allQuotes()) {
+            ids.push_back(store.quoteId(ticker));
+            values.push_back(store.getQuote(ticker)->value() + 0.0001);
+        }
+        builder.updateQuotes(ids, values);
+    };
+    bump(coldStore, coldBuilder);
+    bump(warmStore, warmBuilder);
+
+    Date date = coldBuilder.referenceDate() + 10 * Years;
+    for (const auto& name : coldStore.allCurves())
+        EXPECT_NEAR(coldStore.getCurve(name)->discount(date), warmStore.getCurve(name)->discount(date), 1e-10);
+#ifdef CURVEMANAGER_METRICS
+    uint64_t coldIterations = 0, warmIterations = 0;
+    for (const auto& name : coldStore.allCurves()) {
+        coldIterations += coldStore.metricsRegistry().curveMetrics(name).solverIterations;
+        warmIterations += warmStore.metricsRegistry().curveMetrics(name).solverIterations;
+    }
+    EXPECT_LE(warmIterations, coldIterations);
+#endif
+
+    // the rebuilt curves start from the nodes of the ones they replace
+    double before = warmStore.getCurve("LIBOR1M")->discount(date);
+    warmBuilder.rebootstrap();
+    EXPECT_TRUE(warmStore.curveSeed("LIBOR1M"));
+    EXPECT_NEAR(warmStore.getCurve("LIBOR1M")->discount(date), before, 1e-10);
+}
+
+TEST(CurveManager, QuoteQueueReplay) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    QuoteQueue queue(builder, store);
+    EXPECT_EQ(queue.replay("json/ticks.jsonl"), 8);
+    QuoteQueueStats stats = queue.stats();
+    EXPECT_EQ(stats.received, 8);
+    EXPECT_EQ(stats.dropped, 1);
+    EXPECT_EQ(stats.coalesced, 4);
+    EXPECT_EQ(stats.depth, 3);
+
+    EXPECT_EQ(queue.flush(), 3);
+    EXPECT_EQ(queue.stats().depth, 0);
+    EXPECT_EQ(queue.stats().batches, 1);
+    EXPECT_DOUBLE_EQ(store.getQuote("CF_CLP_1D")->value(), 0.0304);
+    EXPECT_DOUBLE_EQ(store.getQuote("CF_CLP_1W")->value(), 0.0305);
+    EXPECT_DOUBLE_EQ(store.getQuote("USBA1 BGN CURNCY")->value(), 0.0012);
+    EXPECT_EQ(queue.flush(), 0);
+}
+
+TEST(CurveManager, QuoteQueueBackground) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    store.setVersioned(true);
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    QuoteQueue queue(builder, store, 2, std::chrono::milliseconds(5));
+    queue.start();
+    std::vector<std::thread> feeds;
+    for (size_t f = 0; f < 2; ++f) {
+        feeds.emplace_back([&queue, f]() {
+            for (size_t i = 1; i <= 200; ++i) queue.push(f == 0 ? "CF_CLP_1D" : "CF_CLP_1W", 0.03 + 1e-5 * i);
+        });
+    }
+    for (auto& feed : feeds) feed.join();
+    queue.stop();
+
+    QuoteQueueStats stats = queue.stats();
+    EXPECT_EQ(stats.received, 400);
+    EXPECT_EQ(stats.depth, 0);
+    EXPECT_EQ(stats.applied + stats.coalesced, 400);
+    EXPECT_DOUBLE_EQ(store.getQuote("CF_CLP_1D")->value(), 0.032);
+    EXPECT_DOUBLE_EQ(store.getQuote("CF_CLP_1W")->value(), 0.032);
+}
+
+TEST(CurveManager, InternedIds) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    CurveId libor1m = store.curveId("LIBOR1M");
+    QuoteId spread  = store.quoteId("USBA1 BGN CURNCY");
+    EXPECT_EQ(store.curveName(libor1m), "LIBOR1M");
+    EXPECT_EQ(store.quoteTicker(spread), "USBA1 BGN CURNCY");
+    EXPECT_EQ(store.getCurve(libor1m), store.getCurve("LIBOR1M"));
+    EXPECT_THROW(store.curveId("NOT A CURVE"), std::runtime_error);
+    EXPECT_THROW(store.quoteId("NOT A TICKER"), std::runtime_error);
+
+    std::vector<std::string> recalculated = builder.updateQuotes({spread}, {0.05});
+    EXPECT_EQ(recalculated, std::vector<std::string>{"LIBOR1M"});
+    EXPECT_DOUBLE_EQ(store.getQuote(spread)->value(), 0.05);
+
+    Date refDate                         = QuantLibParser::parse<Date>(curveData["REFDATE"]);
+    std::vector<Date::serial_type> dates = {(refDate + Period(1, Years)).serialNumber(), (refDate + Period(7, Years)).serialNumber()};
+    std::vector<double> byName(dates.size()), byId(dates.size());
+    store.discounts("LIBOR1M", dates.data(), dates.size(), byName.data());
+    store.discounts(libor1m, dates.data(), dates.size(), byId.data());
+    EXPECT_EQ(byName, byId);
+}
+
+TEST(CurveManager, DateParser) {
+    for (const std::string date : {"28102022", "29022024", "01011901", "31122199"}) {
+        EXPECT_EQ(cachedParseDate(date), QuantLibParser::parse<Date>(date));
+        EXPECT_EQ(formatDDMMYYYY(cachedParseDate(date)), date);
+    }
+    Date date;
+    EXPECT_FALSE(parseDDMMYYYY("29022023", 8, date));
+    EXPECT_FALSE(parseDDMMYYYY("2810202", 7, date));
+    EXPECT_FALSE(parseDDMMYYYY("28-10-22", 8, date));
+
+    Date refDate(28, October, 2022);
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(cachedFormatDate(refDate), QuantLibParser::parseDate(refDate, QuantLibParser::DateFormat::MIXED));
+    EXPECT_EQ(cachedParseDate(json("28102022")), refDate);
+}
+
+TEST(CurveManager, ConcurrentBuildsForDifferentDates) {
+    json curveData                    = readJSONFile("json/piecewisefull.json");
+    std::vector<std::string> refDates = {"28102022", "31102022", "15112022", "28102022"};
+    std::vector<json> configs;
+    for (const auto& refDate : refDates) {
+        configs.push_back(curveData);
+        configs.back()["REFDATE"] = refDate;
+    }
+
+    Date date = cachedParseDate(refDates[0]) + Period(5, Years);
+    std::vector<double> expected;
+    for (const auto& config : configs) {
+        MarketStore store;
+        CurveBuilder builder(config, store);
+        builder.build();
+        expected.push_back(store.getCurve("LIBOR1M")->discount(date));
+    }
+
+    std::vector<double> results(configs.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < configs.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            MarketStore store;
+            CurveBuilder builder(configs[i], store);
+            builder.build();
+            EXPECT_EQ(store.getCurve("LIBOR1M")->referenceDate(), builder.referenceDate());
+            builder.updateQuotes({store.quoteId("USBA1 BGN CURNCY")}, {store.getQuote("USBA1 BGN CURNCY")->value()});
+            results[i] = store.getCurve("LIBOR1M")->discount(date);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (size_t i = 0; i < configs.size(); ++i) EXPECT_NEAR(results[i], expected[i], 1e-12);
+    EXPECT_NE(expected[0], expected[2]);
+}
+
+TEST(CurveManager, EvaluationDateLock) {
+    Date refDate(28, October, 2022);
+    if (!hasThreadLocalSettings()) {
+        // a shared hold can be nested for its date, but not made exclusive, the default hold included
+        EvaluationDateLock shared(refDate);
+        EXPECT_NO_THROW({ EvaluationDateLock nested(refDate); });
+        EXPECT_THROW({ EvaluationDateLock nested; }, std::runtime_error);
+        EXPECT_THROW({ EvaluationDateLock nested(refDate, EvaluationDateLock::Mode::Exclusive); }, std::runtime_error);
+        EXPECT_THROW({ EvaluationDateLock nested(refDate + 1); }, std::runtime_error);
+        return;
+    }
+
+    // per thread Settings: threads hold other dates at the same time, and workers get the holder's fixings
+    EvaluationDateLock lock(refDate);
+    TimeSeries<Real> fixings;
+    fixings[refDate - 1] = 0.01;
+    IndexManager::instance().setHistory("CURVEMANAGER TEST", fixings);
+    EvaluationDateLock::Context context = EvaluationDateLock::capture(refDate);
+
+    bool hadFixings = true;
+    Date workerDate, otherDate;
+    double fixing = 0.0;
+    std::thread worker([&]() {
+        {
+            EvaluationDateLock other(refDate + 7, EvaluationDateLock::Mode::Exclusive);
+            otherDate = Settings::instance().evaluationDate();
+        }
+        hadFixings = IndexManager::instance().hasHistory("CURVEMANAGER TEST");
+        EvaluationDateLock::inherit(context);
+        workerDate = Settings::instance().evaluationDate();
+        fixing     = IndexManager::instance().getHistory("CURVEMANAGER TEST")[refDate - 1];
+    });
+    worker.join();
+    IndexManager::instance().clearHistory("CURVEMANAGER TEST");
+
+    EXPECT_EQ(otherDate, refDate + 7);
+    EXPECT_FALSE(hadFixings);
+    EXPECT_EQ(workerDate, refDate);
+    EXPECT_EQ(fixing, 0.01);
+    EXPECT_EQ(Settings::instance().evaluationDate(), refDate);
+}
+
+TEST(CurveManager, HistoryEngine) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore baseStore;
+    CurveBuilder baseBuilder(curveData, baseStore);
+    baseBuilder.build();
+
+    // the first day repeats the config quotes, the second one bumps them all by 10bp
+    std::vector<std::string> refDates = {"29082022", "30082022"};
+    std::filesystem::path dir         = std::filesystem::temp_directory_path();
+    std::string quotesPath            = (dir / "curvemanager_history.csv").string();
+    std::string historyPath           = (dir / "curvemanager_history.bin").string();
+    std::string nodesPath             = (dir / "curvemanager_historynodes.bin").string();
+    std::ofstream quotes(quotesPath);
+    quotes << "DATE,TICKER,VALUE\n" << std::setprecision(17);
+    for (size_t i = 0; i < refDates.size(); ++i)
+        for (const auto& ticker : baseStore.allQuotes())
+            quotes << refDates[i] << "," << ticker << "," << baseStore.getQuote(ticker)->value() + 0.001 * i << "\n";
+    quotes.close();
+
+    MarketHistory history = MarketHistory::fromCSV(quotesPath);
+    history.saveBinary(historyPath);
+    MarketHistory loaded = MarketHistory::fromBinary(historyPath);
+    EXPECT_EQ(loaded.dates(), history.dates());
+
+    HistoryEngine engine(curveData, loaded, 2);
+    // the days run on the pool only with per thread Settings, and serially otherwise
+    EXPECT_EQ(engine.run(nodesPath), refDates.size());
+    EXPECT_TRUE(engine.errors().empty());
+
+    std::map<Date, std::vector<double>> nodes;
+    auto visitor = [&](const Date& refDate, const std::string& curve, const std::vector<Date>&, const std::vector<double>& discounts) {
+        if (curve == "SOFR") nodes[refDate] = discounts;
+    };
+    HistoryEngine::readNodes(nodesPath, visitor);
+    for (const auto& path : {quotesPath, historyPath, nodesPath}) std::filesystem::remove(path);
+    ASSERT_EQ(nodes.size(), refDates.size());
+
+    for (size_t i = 0; i < refDates.size(); ++i) {
+        json config       = curveData;
+        config["REFDATE"] = refDates[i];
+        MarketStore store;
+        CurveBuilder builder(config, store);
+        builder.build();
+        json prices = json::array();
+        for (const auto& ticker : store.allQuotes()) prices.push_back({{"NAME", ticker}, {"VALUE", store.getQuote(ticker)->value() + 0.001 * i}});
+        builder.updateQuotes(prices);
+
+        const auto& curve                = store.getBootstrappedCurve("SOFR");
+        const std::vector<double>& built = nodes[cachedParseDate(refDates[i])];
+        ASSERT_EQ(built.size(), curve.data().size());
+        for (size_t j = 0; j < built.size(); ++j) EXPECT_NEAR(built[j], curve.data()[j], 1e-10);
+    }
+}
+
+TEST(CurveManager, BulkFixings) {
+    json curveData = readJSONFile("json/piecewisefull.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    std::vector<std::string> names = {"LIBOR3M", "ICP_ICAP"};
+
+    // columnar file with an empty cell wherever the date is not a fixing date of the index
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string csvPath       = (dir / "curvemanager_fixings.csv").string();
+    std::string binaryPath    = (dir / "curvemanager_fixings.bin").string();
+    size_t expected           = 0;
+    {
+        std::ofstream file(csvPath);
+        file << "DATE," << names[0] << "," << names[1] << "\n" << std::setprecision(17);
+        for (Date date(3, January, 2000); date < Date(1, January, 2020); ++date) {
+            file << formatDDMMYYYY(date);
+            for (const auto& name : names) {
+                file << ",";
+                if (!store.getIndex(name)->isValidFixingDate(date)) continue;
+                file << 0.01 + 1.0e-7 * date.serialNumber();
+                ++expected;
+            }
+            file << "\n";
+        }
+    }
+    FixingsTable fixings = readFixingsCSV(csvPath);
+    writeFixingsBinary(binaryPath, fixings);
+    FixingsTable loaded = readFixings(binaryPath);
+    for (const auto& name : names) {
+        EXPECT_EQ(loaded[name].dates, fixings[name].dates);
+        EXPECT_EQ(loaded[name].values, fixings[name].values);
+    }
+
+    // other tests may have left fixings on the process wide IndexManager
+    for (const auto& name : names) store.getIndex(name)->clearFixings();
+    EXPECT_EQ(store.loadFixings(binaryPath), expected);
+    for (const auto& name : names) {
+        const auto& series = fixings[name];
+        auto history       = store.getIndex(name)->timeSeries();
+        EXPECT_EQ(history.size(), series.dates.size());
+        for (size_t i = 0; i < series.dates.size(); i += 97) EXPECT_DOUBLE_EQ(history[series.dates[i]], series.values[i]);
+    }
+
+    // an unknown index rejects the whole table
+    for (const auto& name : names) store.getIndex(name)->clearFixings();
+    FixingsTable unknown    = fixings;
+    unknown["NOT AN INDEX"] = fixings[names[0]];
+    EXPECT_THROW(store.addFixings(unknown), std::runtime_error);
+    for (const auto& name : names) EXPECT_TRUE(store.getIndex(name)->timeSeries().empty());
+
+    // the first header cell must be DATE
+    {
+        std::ofstream file(csvPath);
+        file << "FECHA," << names[0] << "\n03012000,0.01\n";
+    }
+    EXPECT_THROW(readFixingsCSV(csvPath), std::runtime_error);
+    for (const auto& path : {csvPath, binaryPath}) std::filesystem::remove(path);
+}
+
+TEST(CurveManager, EncodedRequests) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+
+    json request  = R"({"REFDATE":"28082022", "CURVE":"SOFR", "DATES":["29012026", "15062030", "28082040"]})"_json;
+    json expected = store.discountRequest(request);
+
+    // the tree encodings answer the same document as the json endpoint
+    for (auto encoding : {Encoding::JSON, Encoding::CBOR, Encoding::MessagePack}) {
+        ResponseEncoder encoder(encoding);
+        auto in         = encodeDocument(request, encoding);
+        const auto& out = store.discountRequest(in.data(), in.size(), encoding, encoder);
+        EXPECT_EQ(decodeDocument(out.data(), out.size(), encoding), expected);
+    }
+
+    ColumnarQuery query;
+    query.curve = "SOFR";
+    for (const auto& row : expected) query.dates.push_back(cachedParseDate(row["DATE"]).serialNumber());
+    auto in = encodeColumnarQuery(query);
+    EXPECT_EQ(decodeColumnarQuery(in.data(), in.size()).dates, query.dates);
+
+    ResponseEncoder encoder(Encoding::Columnar);
+    const auto& out = store.discountRequest(in.data(), in.size(), Encoding::Columnar, encoder);
+    std::vector<Date::serial_type> dates;
+    std::vector<double> values;
+    decodeColumnarResponse(out.data(), out.size(), dates, values);
+    EXPECT_EQ(dates, query.dates);
+    for (size_t i = 0; i < values.size(); ++i) EXPECT_EQ(values[i], expected[i]["VALUE"].get<double>());
+
+    // columnar zero rates take the request defaults for the empty conventions
+    json zeroRequest          = request;
+    zeroRequest["DAYCOUNTER"] = "ACT365";
+    json zeroExpected         = store.zeroRateRequest(zeroRequest);
+    query.dayCounter          = "ACT365";
+    in                        = encodeColumnarQuery(query);
+    store.zeroRateRequest(in.data(), in.size(), Encoding::Columnar, encoder);
+    decodeColumnarResponse(encoder.buffer().data(), encoder.buffer().size(), dates, values);
+    for (size_t i = 0; i < values.size(); ++i) EXPECT_EQ(values[i], zeroExpected[i]["VALUE"].get<double>());
+
+    EXPECT_THROW(decodeColumnarQuery(out.data(), out.size()), std::runtime_error);
+
+    // forward rates: the pairs of the json endpoint, or the start and end dates of a columnar query
+    json forwardRequest  = R"({"REFDATE":"28082022", "CURVE":"SOFR", "DATES":[["29012026", "15062030"], ["15062030", "28082040"]]})"_json;
+    json forwardExpected = store.forwardRateRequest(forwardRequest);
+    for (auto encoding : {Encoding::JSON, Encoding::CBOR, Encoding::MessagePack}) {
+        ResponseEncoder forwardEncoder(encoding);
+        auto forwardIn = encodeDocument(forwardRequest, encoding);
+        store.forwardRateRequest(forwardIn.data(), forwardIn.size(), encoding, forwardEncoder);
+        EXPECT_EQ(decodeDocument(forwardEncoder.buffer().data(), forwardEncoder.buffer().size(), encoding), forwardExpected);
+    }
+
+    ColumnarQuery forwardQuery;
+    forwardQuery.curve = "SOFR";
+    for (const auto& pair : forwardRequest["DATES"]) {
+        forwardQuery.dates.push_back(cachedParseDate(pair[0]).serialNumber());
+        forwardQuery.endDates.push_back(cachedParseDate(pair[1]).serialNumber());
+    }
+    in = encodeColumnarQuery(forwardQuery);
+    store.forwardRateRequest(in.data(), in.size(), Encoding::Columnar, encoder);
+    std::vector<Date::serial_type> endDates;
+    decodeColumnarForwardResponse(encoder.buffer().data(), encoder.buffer().size(), dates, endDates, values);
+    EXPECT_EQ(dates, forwardQuery.dates);
+    EXPECT_EQ(endDates, forwardQuery.endDates);
+    for (size_t i = 0; i < values.size(); ++i) EXPECT_EQ(values[i], forwardExpected["VALUES"][i].get<double>());
+
+    // columnar queries get the checks of the json schemas: a curve, representable dates and one end date per start date
+    EXPECT_THROW(store.discountRequest(in.data(), in.size(), Encoding::Columnar, encoder), std::runtime_error);
+    forwardQuery.endDates.pop_back();
+    EXPECT_THROW(encodeColumnarQuery(forwardQuery), std::runtime_error);
+    query.curve = "";
+    in          = encodeColumnarQuery(query);
+    EXPECT_THROW(store.discountRequest(in.data(), in.size(), Encoding::Columnar, encoder), std::runtime_error);
+    query.curve = "SOFR";
+    query.dates.push_back(0);
+    in = encodeColumnarQuery(query);
+    EXPECT_THROW(store.zeroRateRequest(in.data(), in.size(), Encoding::Columnar, encoder), std::runtime_error);
+}
+
+TEST(CurveManager, ScenarioEngine) {
+    json curveData = readJSONFile("json/piecewise.json");
+    MarketStore store;
+    CurveBuilder builder(curveData, store);
+    builder.build();
+    auto curve = store.getCurve("SOFR");
+
+    std::vector<Time> pillars = {1.0, 2.0, 5.0, 10.0, 30.0};
+    ScenarioEngine zero(store, "SOFR", pillars, SpreadType::Zero);
+    ScenarioEngine forward(store, "SOFR", pillars, SpreadType::Forward);
+
+    std::vector<Date::serial_type> dates;
+    for (int i = 1; i <= 40; ++i) dates.push_back((curve->referenceDate() + 200 * i).serialNumber());
+
+    Matrix spreads(4, pillars.size());
+    std::vector<std::vector<double>> rows = {zero.parallel(0.0), zero.parallel(0.01), zero.keyRate(2, 0.01), zero.twist(-0.01, 0.01)};
+    for (size_t s = 0; s < rows.size(); ++s) std::copy(rows[s].begin(), rows[s].end(), spreads.row_begin(s));
+    Matrix zeroDiscounts    = zero.discounts(spreads, dates);
+    Matrix forwardDiscounts = forward.discounts(spreads, dates);
+    ASSERT_EQ(zeroDiscounts.rows(), rows.size());
+    ASSERT_EQ(zeroDiscounts.columns(), dates.size());
+
+    for (size_t j = 0; j < dates.size(); ++j) {
+        Date date = Date(dates[j]);
+        Time t    = curve->timeFromReference(date);
+        double df = curve->discount(date);
+        EXPECT_NEAR(zeroDiscounts[0][j], df, 1e-12);
+        EXPECT_NEAR(forwardDiscounts[0][j], df, 1e-12);
+        // a flat spread is the same in zero and forward terms
+        EXPECT_NEAR(zeroDiscounts[1][j], df * std::exp(-0.01 * t), 1e-12);
+        EXPECT_NEAR(forwardDiscounts[1][j], df * std::exp(-0.01 * t), 1e-12);
+        // a key rate bump only moves the dates between its neighbours
+        if (t <= 2.0 || t >= 10.0) EXPECT_NEAR(zeroDiscounts[2][j], df, 1e-12);
+        if (t <= 2.0) EXPECT_NEAR(forwardDiscounts[2][j], df, 1e-12);
+    }
+
+    // the forward key rate bump is a triangle of area 0.01 * (10 - 2) / 2: dates past 10Y move by all of it
+    Date longDate = curve->referenceDate() + 365 * 20;
+    Time tLong    = curve->timeFromReference(longDate);
+    Matrix bumped = forward.discounts(spreads, {longDate.serialNumber()});
+    EXPECT_NEAR(bumped[2][0], curve->discount(tLong) * std::exp(-0.01 * 4.0), 1e-12);
+
+    // continuous zero rates in the curve day counter move by the zero spread
+    Matrix rates = zero.zeroRates(spreads, dates, curve->dayCounter(), Continuous, Annual);
+    for (size_t j = 0; j < dates.size(); ++j) EXPECT_NEAR(rates[1][j] - rates[0][j], 0.01, 1e-12);
+
+    EXPECT_THROW((ScenarioEngine(store, "SOFR", {2.0, 1.0})), std::runtime_error);
+    EXPECT_THROW(zero.discounts(Matrix(1, 2), dates), std::runtime_error);
+}
@@ -61,4 +61,14 @@ TEST(Requests, ForwardRatesRequest) {
 
     QLP::Schema<QLP::ForwardRatesRequest> schema;
     EXPECT_NO_THROW(schema.validate(data));
+}
+
+TEST(Requests, JacobianRequest) {
+    json data = R"({
+		"REFDATE":"24082022",
+		"CURVE":"ICP_ICAP"
+	})"_json;
+
+    QLP::Schema<QLP::JacobianRequest> schema;
+    EXPECT_NO_THROW(schema.validate(data));
 }
\ No newline at end of file